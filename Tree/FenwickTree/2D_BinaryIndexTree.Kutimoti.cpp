@@ -1,52 +1,89 @@
+#include <functional>
 #include <vector>
 using namespace std;
 
+// Group : 可換群 , Add : 演算 , Sub : 逆演算
+template <class Group, class Add = plus<Group>, class Sub = minus<Group>>
+struct BIT_2D {
+  // row-major , bit[i * M + j]
+  vector<Group> bit;
+  // identity element
+  Group ide;
+  // rows
+  int N;
+  // columns
+  int M;
 
-template <class Monoid>
-struct BIT_2D{
-    vector<vector<Monoid>> bit;
-    //identity element
-    Monoid ide;
-    //bit.size()
-    int N;
-    //bit[i].size()
-    int M;
-
-    BIT_2D(int n,int m,Monoid ide) : N(n) , M(m) ,ide(ide), bit(N,vector<Monoid>(M,ide)){}
-
-    void add(int r,int c,Monoid value){
-        for(int i = r;i < N;i |= i + 1){
-            for(int j = c;j < M;j |= j + 1){
-                bit[i][j] += value;
-            }
-        }
-    }
-    
-    
-    //sum[(0,0),(r,c)]
-    Monoid sum(int r,int c){
-        int res = 0;
-        for(int i = r;i >= 0;i = (i & (i + 1)) - 1){
-            for(int j = c;j >= 0;j = (j & (j + 1)) - 1){
-                res += bit[i][j];
-            }
-        }
-        return res;
+  Add add_f;
+  Sub sub_f;
+
+  BIT_2D(int n, int m, Group ide, Add a = Add(), Sub s = Sub())
+      : bit(n * m, ide), ide(ide), N(n), M(m), add_f(a), sub_f(s) {}
+
+  // init[i * m + j] を (i, j) の初期値として O(NM) で構築する
+  BIT_2D(int n, int m, const vector<Group>& init, Group ide, Add a = Add(),
+         Sub s = Sub())
+      : bit(init), ide(ide), N(n), M(m), add_f(a), sub_f(s) {
+    for (int i = 0; i < N; i++) {
+      Group* row = &bit[i * M];
+      for (int j = 0, p; j < M; j++)
+        if ((p = j | (j + 1)) < M) row[p] = add_f(row[p], row[j]);
     }
-    //sum[(r1,c1),(r2,c2)]
-    Monoid sum(int r1,int c1,int r2,int c2){
-        return sum(r2,c2) - sum(r1 - 1,c2) - sum(r2,c1 - 1) + sum(r1 - 1 , c1 - 1);
+    for (int i = 0, p; i < N; i++) {
+      if ((p = i | (i + 1)) >= N) continue;
+      const Group* from = &bit[i * M];
+      Group* to = &bit[p * M];
+      for (int j = 0; j < M; j++) to[j] = add_f(to[j], from[j]);
     }
+  }
 
-    Monoid get(int r,int c){
-        return sum(r,c,r,c);
+  void add(int r, int c, Group value) {
+    for (int i = r; i < N; i |= i + 1) {
+      Group* row = &bit[i * M];
+      for (int j = c; j < M; j |= j + 1) row[j] = add_f(row[j], value);
     }
+  }
+
+  // sum[(0,0),(r,c)]
+  Group sum(int r, int c) { return sum(0, 0, r, c); }
 
-    void set(int r,int c,Monoid value){
-        add(r,c,value - get(r,c));
+  // sum[(r1,c1),(r2,c2)]
+  // [0, r2] と [0, r1) の経路の共通部分は打ち消し合うので辿らない
+  // 列の経路は全ての行で共通なので、先に 1 度だけ求める
+  Group sum(int r1, int c1, int r2, int c2) {
+    int plus_col[32], minus_col[32];
+    int np = 0, nm = 0;
+    for (int a = c2 + 1, b = c1; a != b;) {
+      if (a > b) {
+        plus_col[np++] = a - 1;
+        a &= a - 1;
+      } else {
+        minus_col[nm++] = b - 1;
+        b &= b - 1;
+      }
     }
+    Group res = ide;
+    for (int a = r2 + 1, b = r1; a != b;) {
+      const Group* row = &bit[((a > b ? a : b) - 1) * M];
+      Group cur = ide;
+      for (int k = 0; k < np; k++) cur = add_f(cur, row[plus_col[k]]);
+      for (int k = 0; k < nm; k++) cur = sub_f(cur, row[minus_col[k]]);
+      if (a > b) {
+        res = add_f(res, cur);
+        a &= a - 1;
+      } else {
+        res = sub_f(res, cur);
+        b &= b - 1;
+      }
+    }
+    return res;
+  }
+
+  Group get(int r, int c) { return sum(r, c, r, c); }
+
+  void set(int r, int c, Group value) { add(r, c, sub_f(value, get(r, c))); }
 };
 
 /*
 checked : http://judge.u-aizu.ac.jp/onlinejudge/review.jsp?rid=2756697#1
-*/
\ No newline at end of file
+*/
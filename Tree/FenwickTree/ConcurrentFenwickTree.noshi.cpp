@@ -0,0 +1,127 @@
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+template <class Integral> class concurrent_fenwick_tree {
+public:
+  using value_type = Integral;
+  using size_type = ::std::size_t;
+
+private:
+  static constexpr size_type linesize = 64;
+  static constexpr size_type line =
+      linesize / sizeof(::std::atomic<value_type>);
+
+  static size_type shard() {
+    static ::std::atomic<size_type> next(0);
+    thread_local const size_type ret = next++;
+    return ret;
+  }
+
+  size_type size_, shards, stride, origin;
+  ::std::vector<::std::atomic<value_type>> tree;
+
+public:
+  explicit concurrent_fenwick_tree(const size_type size = 0,
+                                   const size_type shards = 1)
+      : size_(size), shards(shards),
+        stride((size + 1 + line - 1) / line * line), origin(0),
+        tree(shards * stride + line - 1) {
+    assert(shards);
+    for (::std::atomic<value_type> &node : tree)
+      node.store(0, ::std::memory_order_relaxed);
+    const ::std::uintptr_t address =
+        reinterpret_cast<::std::uintptr_t>(tree.data());
+    origin = (linesize - address % linesize) % linesize /
+             sizeof(::std::atomic<value_type>);
+  }
+  concurrent_fenwick_tree(const concurrent_fenwick_tree &) = delete;
+  concurrent_fenwick_tree &operator=(const concurrent_fenwick_tree &) = delete;
+
+  bool empty() const { return size() == 0; }
+  size_type size() const { return size_; }
+
+  value_type fold(size_type last) const {
+    assert(last <= size());
+    value_type ret = 0;
+    for (; last; last &= last - 1)
+      for (size_type s = 0; s != shards; ++s)
+        ret += tree[origin + s * stride + last].load(
+            ::std::memory_order_relaxed);
+    return ret;
+  }
+
+  void add(size_type index, const value_type value) {
+    assert(index < size());
+    const size_type base = origin + shard() % shards * stride;
+    for (++index; index <= size_; index += index & (~index + 1))
+      tree[base + index].fetch_add(value, ::std::memory_order_relaxed);
+  }
+};
+
+/*
+
+template<class Integral>
+class concurrent_fenwick_tree;
+
+concurrent_fenwick_tree は複数のスレッドから同時に add と fold を
+呼び出すことができる、整数の区間和のための fenwick_tree です
+ロックを取らず、各節点を relaxed な原子操作で読み書きします
+1 つの要素は fold(last) で読む節点のうち高々 1 つにのみ含まれるため、
+fold は実行中の各 add の結果を全て含むか全く含まないかのどちらかです
+異なる add の間の順序は保証されません
+shards を 2 以上にすると、スレッドごとに別の木に加算し、fold で全ての木の和を
+取ります
+add が同じ節点に集中する場合の競合が減る代わりに、fold が遅くなります
+各木の先頭を 64 byte 境界に揃えて配置するため、
+異なる木の節点が同じキャッシュラインに載ることはありません
+空間計算量 O(NS)
+
+
+テンプレートパラメータ
+-class Integral
+ 整数型
+ ::std::atomic<Integral> の fetch_add が使用できる必要があります
+
+
+メンバ型
+-value_type
+ 要素の型 (Integral)
+
+-size_type
+ 符号なし整数型 (::std::size_t)
+
+
+メンバ関数
+-(constructor) (size_type size = 0, size_type shards = 1)
+ size 個の要素からなる concurrent_fenwick_tree を構築します
+ 各要素は 0 で初期化されます
+ 加算先の木を shards 個持ちます
+ 時間計算量 O(NS)
+
+-empty ()->bool
+ size()==0 と等価です
+ 時間計算量 O(1)
+
+-size ()->size_type
+ 要素数を返します
+ 時間計算量 O(1)
+
+以下の関数は複数のスレッドから同時に呼び出すことができます
+
+-fold (size_type last)->value_type
+ [0, last) の和を返します
+ last == 0 のとき 0 を返します
+ 時間計算量 O(SlogN)
+
+-add (size_type index, value_type value)
+ index で指定した要素に value を加算します
+ 時間計算量 O(logN)
+
+
+※N:全体の要素数
+※S:shards
+
+*/
@@ -20,11 +20,30 @@ private:
       ret <<= 1;
     return ret;
   }
+  void build() {
+    for (size_type i = 1, j; i < tree.size(); ++i)
+      if ((j = i + (i & (~i + 1))) < tree.size())
+        tree[j] = value_structure::operation(::std::move(tree[j]), tree[i]);
+  }
 
 public:
   fenwick_tree() : base_size(0), tree() {}
   explicit fenwick_tree(const size_type size)
       : base_size(getsize(size)), tree(size + 1, value_structure::identity()) {}
+  template <class InputIterator>
+  fenwick_tree(InputIterator first, InputIterator last)
+      : base_size(0), tree() {
+    assign(first, last);
+  }
+
+  template <class InputIterator>
+  void assign(InputIterator first, InputIterator last) {
+    tree.resize(1);
+    tree[0] = value_structure::identity();
+    tree.insert(tree.end(), first, last);
+    base_size = getsize(size());
+    build();
+  }
 
   bool empty() const { return size() == 0; }
   size_type size() const { return tree.size() - 1; }
@@ -110,6 +129,19 @@ fenwick_tree は可換モノイドの区間和を高速に計算するデータ
  各要素は単位元で初期化されます
  時間計算量 O(N)
 
+template<class InputIterator>
+-(constructor) (InputIterator first, InputIterator last)
+ [first, last) の要素から fenwick_tree を構築します
+ 各節点に子の値を 1 度ずつ加算して構築します
+ 時間計算量 O(N)
+
+template<class InputIterator>
+-assign (InputIterator first, InputIterator last)
+ 全ての要素を [first, last) の要素で置き換えます
+ 要素数が変わっても構いません
+ container_type の容量が足りる場合、再確保は行いません
+ 時間計算量 O(N)
+
 -empty ()->bool
  size()==0 と等価です
  時間計算量 O(1)
@@ -0,0 +1,209 @@
+#include <cassert>
+#include <utility>
+#include <vector>
+
+template <class CommutativeMonoid, template <class> class Container>
+class level_fenwick_tree {
+
+public:
+  using value_structure = CommutativeMonoid;
+  using value_type = typename value_structure::value_type;
+  using container_type = Container<value_type>;
+  using const_reference = typename container_type::const_reference;
+  using size_type = typename container_type::size_type;
+
+private:
+  size_type size_, height;
+  ::std::vector<size_type> offset;
+  container_type tree;
+
+  static size_type level(size_type index) {
+#ifdef __has_builtin
+    return static_cast<size_type>(__builtin_ctzll(index));
+#else
+    size_type ret = 0;
+    for (; !(index & 1); index >>= 1)
+      ++ret;
+    return ret;
+#endif
+  }
+  size_type position(const size_type index) const {
+    const size_type h = level(index);
+    return offset[h] + (index >> (h + 1));
+  }
+  void layout() {
+    height = 0;
+    while (static_cast<size_type>(1) << height <= size_)
+      ++height;
+    offset.assign(height + 1, 0);
+    for (size_type h = height; h--;)
+      offset[h] = offset[h + 1] + (((size_ >> (h + 1)) + 1) >> 1);
+  }
+  void build() {
+    for (size_type i = 1, j; i <= size_; ++i)
+      if ((j = i + (i & (~i + 1))) <= size_)
+        tree[position(j)] = value_structure::operation(
+            ::std::move(tree[position(j)]), tree[position(i)]);
+  }
+
+public:
+  level_fenwick_tree() : size_(0), height(0), offset(1, 0), tree() {}
+  explicit level_fenwick_tree(const size_type size)
+      : size_(size), height(0), offset(),
+        tree(size, value_structure::identity()) {
+    layout();
+  }
+  template <class InputIterator>
+  level_fenwick_tree(InputIterator first, InputIterator last)
+      : size_(0), height(0), offset(), tree() {
+    assign(first, last);
+  }
+
+  template <class InputIterator>
+  void assign(InputIterator first, InputIterator last) {
+    ::std::vector<value_type> values(first, last);
+    size_ = values.size();
+    layout();
+    tree.resize(size_);
+    for (size_type i = 1; i <= size_; ++i)
+      tree[position(i)] = ::std::move(values[i - 1]);
+    build();
+  }
+
+  bool empty() const { return size() == 0; }
+  size_type size() const { return size_; }
+
+  value_type fold(size_type last) const {
+    assert(last <= size());
+    value_type ret = value_structure::identity();
+    for (; last; last &= last - 1)
+      ret = value_structure::operation(tree[position(last)], ::std::move(ret));
+    return ret;
+  }
+  template <class F> size_type search(const F &f) const {
+    if (f(value_structure::identity()))
+      return 0;
+    size_type i = 0;
+    value_type acc = value_structure::identity();
+    for (size_type h = height; h--;) {
+      const size_type k = static_cast<size_type>(1) << h;
+      if ((i | k) > size_)
+        continue;
+      const_reference node = tree[offset[h] + (i >> (h + 1))];
+#ifdef __has_builtin
+      if (h && (i | k >> 1) <= size_)
+        __builtin_prefetch(&tree[offset[h - 1] + (i >> h)]);
+#endif
+      if (!f(value_structure::operation(acc, node))) {
+        acc = value_structure::operation(::std::move(acc), node);
+        i |= k;
+      }
+    }
+    return i + 1;
+  }
+
+  void add(size_type index, const value_type &value) {
+    assert(index < size());
+    for (++index; index <= size_; index += index & (~index + 1))
+      tree[position(index)] =
+          value_structure::operation(::std::move(tree[position(index)]), value);
+  }
+};
+
+/*
+
+template<class CommutativeMonoid, template <class> class Container>
+class level_fenwick_tree;
+
+level_fenwick_tree は fenwick_tree と同じ操作を持ち、節点の配置を変えたものです
+節点 i を i を割り切る最大の 2 冪ごとに分け、大きい方から順に並べます
+根に近い節点が配列の先頭にまとまるため、要素数が大きい場合にも
+fold と search の各段の多くがキャッシュに載ります
+search で次の段に進むときに選ばれうる 2 つの節点は隣接しているため、
+比較の前にそれらを先読みします
+空間計算量 O(N)
+
+
+テンプレートパラメータ
+-class CommutativeMonoid
+ -結合律
+  ∀a, ∀b, ∀c, a·(b·c) = (a·b)·c
+ -交換律
+  ∀a, ∀b, a·b = b·a
+ -単位元の存在
+  ∃e, ∀a, e·a = a·e = a
+ 以上の条件を満たす代数的構造 (可換モノイド)
+
+ 以下のメンバを要求します
+ -value_type
+  台集合の型
+ -static operation (value_type, value_type)->value_type
+  2引数を取り、演算した結果を返す静的関数
+ -static identity ()->value_type
+  単位元を返す静的関数
+
+-template <class> class Container
+ 型引数を1つ取り、それを要素とするコンテナ型
+ 内部実装で使用します
+
+
+メンバ型
+-value_structure
+ 構造の型 (CommutativeMonoid)
+
+-value_type
+ 要素となる台集合の型 (value_structure::value_type)
+
+-container_type
+ コンテナの型 (Container<value_type>)
+
+-size_type
+ 符号なし整数型 (container_type::size_type)
+
+
+メンバ関数
+-(constructor) (size_type size)
+ size 個の要素からなる level_fenwick_tree を構築します
+ 各要素は単位元で初期化されます
+ 時間計算量 O(N)
+
+template<class InputIterator>
+-(constructor) (InputIterator first, InputIterator last)
+ [first, last) の要素から level_fenwick_tree を構築します
+ 時間計算量 O(N)
+
+template<class InputIterator>
+-assign (InputIterator first, InputIterator last)
+ 全ての要素を [first, last) の要素で置き換えます
+ 時間計算量 O(N)
+
+-empty ()->bool
+ size()==0 と等価です
+ 時間計算量 O(1)
+
+-size ()->size_type
+ 要素数を返します
+ 時間計算量 O(1)
+
+-fold (size_type last)->value_type
+ [0, last) の和を返します
+ last == 0 のとき 単位元を返します
+ 時間計算量 O(logN)
+
+template<class F>
+-search (F f)->size_type
+ f(fold(i - 1)) が false を返し、
+ f(fold(i))     が true  を返すような i を返します
+ f(fold(-1))         は false、
+ f(fold(size() + 1)) は true と扱います
+ 時間計算量 O(logN)
+
+-add (size_type index, const value_type &value)
+ index で指定した要素に value を加算します
+ 時間計算量 O(logN)
+
+
+※N:全体の要素数
+※value_structure の各関数の時間計算量を O(1) と仮定
+
+*/
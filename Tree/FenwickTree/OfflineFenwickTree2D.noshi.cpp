@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+template <class CommutativeGroup, class Key> class offline_fenwick_tree_2d {
+public:
+  using value_structure = CommutativeGroup;
+  using value_type = typename value_structure::value_type;
+  using key_type = Key;
+  using size_type = ::std::size_t;
+
+private:
+  size_type size_;
+  ::std::vector<key_type> xs;
+  ::std::vector<size_type> start;
+  ::std::vector<key_type> ys;
+  ::std::vector<value_type> tree;
+
+  value_type fold_node(const size_type node, const key_type &y_first,
+                       const key_type &y_last) const {
+    const size_type b = start[node - 1], e = start[node];
+    size_type first = ::std::lower_bound(ys.begin() + b, ys.begin() + e,
+                                         y_first) - ys.begin() - b,
+              last = ::std::lower_bound(ys.begin() + b + first, ys.begin() + e,
+                                        y_last) - ys.begin() - b;
+    value_type ret = value_structure::identity();
+    while (first != last) {
+      if (first < last) {
+        ret = value_structure::operation(::std::move(ret), tree[b + last - 1]);
+        last &= last - 1;
+      } else {
+        ret = value_structure::operation(
+            ::std::move(ret), value_structure::inverse(tree[b + first - 1]));
+        first &= first - 1;
+      }
+    }
+    return ret;
+  }
+
+public:
+  offline_fenwick_tree_2d() : size_(0), xs(), start(1, 0), ys(), tree() {}
+  template <class InputIterator>
+  offline_fenwick_tree_2d(InputIterator first, InputIterator last)
+      : size_(0), xs(), start(), ys(), tree() {
+    ::std::vector<::std::pair<key_type, key_type>> points(first, last);
+    ::std::sort(points.begin(), points.end());
+    points.erase(::std::unique(points.begin(), points.end()), points.end());
+    size_ = points.size();
+    for (const auto &p : points)
+      if (xs.empty() || xs.back() < p.first)
+        xs.push_back(p.first);
+    const size_type n = xs.size();
+    start.assign(n + 1, 0);
+    for (size_type i = 0, x = 0; i != size_; ++i) {
+      if (xs[x] < points[i].first)
+        ++x;
+      for (size_type k = x + 1; k <= n; k += k & (~k + 1))
+        ++start[k];
+    }
+    for (size_type k = 1; k <= n; ++k)
+      start[k] += start[k - 1];
+    ys.resize(start[n]);
+    ::std::vector<size_type> pos(start.begin(), start.end() - 1);
+    for (size_type i = 0, x = 0; i != size_; ++i) {
+      if (xs[x] < points[i].first)
+        ++x;
+      for (size_type k = x + 1; k <= n; k += k & (~k + 1))
+        ys[pos[k - 1]++] = points[i].second;
+    }
+    size_type len = 0;
+    for (size_type k = 1, b = 0; k <= n; ++k) {
+      ::std::sort(ys.begin() + b, ys.begin() + start[k]);
+      for (const size_type e = start[k]; b != e; ++b)
+        if (len == start[k - 1] || ys[len - 1] < ys[b])
+          ys[len++] = ys[b];
+      start[k] = len;
+    }
+    ys.resize(len);
+    tree.assign(len, value_structure::identity());
+  }
+
+  bool empty() const { return !size_; }
+  size_type size() const { return size_; }
+
+  value_type fold(const key_type &x_first, const key_type &x_last,
+                  const key_type &y_first, const key_type &y_last) const {
+    assert(!(x_last < x_first));
+    assert(!(y_last < y_first));
+    size_type first = ::std::lower_bound(xs.begin(), xs.end(), x_first) -
+                      xs.begin(),
+              last = ::std::lower_bound(xs.begin(), xs.end(), x_last) -
+                     xs.begin();
+    value_type ret = value_structure::identity();
+    while (first != last) {
+      if (first < last) {
+        ret = value_structure::operation(::std::move(ret),
+                                         fold_node(last, y_first, y_last));
+        last &= last - 1;
+      } else {
+        ret = value_structure::operation(
+            ::std::move(ret),
+            value_structure::inverse(fold_node(first, y_first, y_last)));
+        first &= first - 1;
+      }
+    }
+    return ret;
+  }
+
+  void add(const key_type &x, const key_type &y, const value_type &value) {
+    const size_type n = xs.size();
+    size_type k = ::std::lower_bound(xs.begin(), xs.end(), x) - xs.begin();
+    assert(k != n && !(x < xs[k]));
+    for (++k; k <= n; k += k & (~k + 1)) {
+      const size_type b = start[k - 1], e = start[k];
+      size_type j = ::std::lower_bound(ys.begin() + b, ys.begin() + e, y) -
+                    ys.begin() - b;
+      assert(j != e - b && !(y < ys[b + j]));
+      for (++j; j <= e - b; j += j & (~j + 1))
+        tree[b + j - 1] = value_structure::operation(
+            ::std::move(tree[b + j - 1]), value);
+    }
+  }
+};
+
+/*
+
+template<class CommutativeGroup, class Key>
+class offline_fenwick_tree_2d;
+
+offline_fenwick_tree_2d は加算する座標を構築時に与えておき、
+長方形領域の和を高速に計算する 2 次元の fenwick_tree です
+x 座標を圧縮した fenwick_tree の各節点が、その区間に含まれる点の
+y 座標を圧縮した fenwick_tree を持ちます
+全ての節点の y 座標と値はそれぞれ 1 つの配列に連続して確保します
+座標の範囲によらず、点の数のみに依存する量のメモリを使用します
+空間計算量 O(NlogN)
+
+
+テンプレートパラメータ
+-class CommutativeGroup
+ -結合律
+  ∀a, ∀b, ∀c, a·(b·c) = (a·b)·c
+ -交換律
+  ∀a, ∀b, a·b = b·a
+ -単位元の存在
+  ∃e, ∀a, e·a = a·e = a
+ -逆元の存在
+  ∀a, ∃a^-1, a·(a^-1) = (a^-1)·a = e
+ 以上の条件を満たす代数的構造 (可換群)
+
+ 以下のメンバを要求します
+ -value_type
+  台集合の型
+ -static operation (value_type, value_type)->value_type
+  2引数を取り、演算した結果を返す静的関数
+ -static identity ()->value_type
+  単位元を返す静的関数
+ -static inverse (value_type)->value_type
+  1引数を取り、逆元を返す静的関数
+
+-class Key
+ 座標の型
+ < で全順序が定まっている必要があります
+
+
+メンバ型
+-value_structure
+ 構造の型 (CommutativeGroup)
+
+-value_type
+ 要素となる台集合の型 (value_structure::value_type)
+
+-key_type
+ 座標の型 (Key)
+
+-size_type
+ 符号なし整数型 (::std::size_t)
+
+
+メンバ関数
+template<class InputIterator>
+-(constructor) (InputIterator first, InputIterator last)
+ [first, last) の各要素 (x, y) を加算する座標として
+ offline_fenwick_tree_2d を構築します
+ 各座標の値は単位元で初期化されます
+ 時間計算量 O(Nlog^2N)
+
+-empty ()->bool
+ size()==0 と同値です
+ 時間計算量 O(1)
+
+-size ()->size_type
+ 相異なる座標の数を返します
+ 時間計算量 O(1)
+
+-fold (key_type x_first, key_type x_last, key_type y_first, key_type y_last)
+ ->value_type
+ x_first <= x < x_last かつ y_first <= y < y_last を満たす座標の値の和を
+ 返します
+ x_first <= x_last かつ y_first <= y_last である必要があります
+ 時間計算量 O(log^2N)
+
+-add (key_type x, key_type y, const value_type &value)
+ 座標 (x, y) の値に value を加算します
+ (x, y) は構築時に与えた座標である必要があります
+ 時間計算量 O(log^2N)
+
+
+※N:構築時に与えた座標の数
+※value_structure の各関数の時間計算量を O(1) と仮定
+
+*/
@@ -0,0 +1,174 @@
+#include <cassert>
+#include <iterator>
+#include <utility>
+
+template <class CommutativeRing, template <class> class Container>
+class range_fenwick_tree {
+
+public:
+  using value_structure = CommutativeRing;
+  using value_type = typename value_structure::value_type;
+  using container_type = Container<::std::pair<value_type, value_type>>;
+  using size_type = typename container_type::size_type;
+
+private:
+  container_type tree;
+
+  void apply(size_type index, const value_type &value,
+             const value_type &scaled) {
+    for (++index; index < tree.size(); index += index & (~index + 1)) {
+      tree[index].first = value_structure::plus(tree[index].first, value);
+      tree[index].second = value_structure::plus(tree[index].second, scaled);
+    }
+  }
+
+public:
+  range_fenwick_tree() : tree() {}
+  explicit range_fenwick_tree(const size_type size)
+      : tree(size + 1, {value_structure::zero(), value_structure::zero()}) {}
+  template <class InputIterator>
+  range_fenwick_tree(InputIterator first, InputIterator last) : tree() {
+    tree.reserve(::std::distance(first, last) + 1);
+    tree.emplace_back(value_structure::zero(), value_structure::zero());
+    for (; first != last; ++first)
+      tree.emplace_back(value_structure::zero(),
+                        value_structure::minus(value_structure::zero(),
+                                               *first));
+    for (size_type i = 1, j; i < tree.size(); ++i)
+      if ((j = i + (i & (~i + 1))) < tree.size())
+        tree[j].second = value_structure::plus(tree[j].second, tree[i].second);
+  }
+
+  bool empty() const { return size() == 0; }
+  size_type size() const { return tree.size() - 1; }
+
+  value_type fold(size_type last) const {
+    assert(last <= size());
+    value_type ret_a = value_structure::zero(),
+               ret_b = value_structure::zero();
+    const value_type scale = static_cast<value_type>(last);
+    for (; last; last &= last - 1) {
+      ret_a = value_structure::plus(ret_a, tree[last].first);
+      ret_b = value_structure::plus(ret_b, tree[last].second);
+    }
+    return value_structure::minus(value_structure::times(ret_a, scale),
+                                  ret_b);
+  }
+  value_type fold(const size_type first, const size_type last) const {
+    assert(first <= last);
+    assert(last <= size());
+    return value_structure::minus(fold(last), fold(first));
+  }
+
+  void add(const size_type first, const size_type last,
+           const value_type &value) {
+    assert(first <= last);
+    assert(last <= size());
+    if (first == last)
+      return;
+    apply(first, value,
+          value_structure::times(value, static_cast<value_type>(first)));
+    if (last != size())
+      apply(last, value_structure::minus(value_structure::zero(), value),
+            value_structure::minus(
+                value_structure::zero(),
+                value_structure::times(value, static_cast<value_type>(last))));
+  }
+};
+
+/*
+
+template<class CommutativeRing, template <class> class Container>
+class range_fenwick_tree;
+
+range_fenwick_tree は可換環の区間加算と区間和を高速に計算するデータ構造です
+fenwick_tree を 2 つ用いる方法で、2 つの木の節点を組にして
+1 つの配列に確保するため、fold の各段で触れる位置は 1 か所です
+空間計算量 O(N)
+
+
+テンプレートパラメータ
+-class CommutativeRing
+ (加法を +、乗法を *、加法の単位元を 0 と表記)
+ -加法の結合律、交換律
+  ∀a, ∀b, ∀c, a+(b+c) = (a+b)+c
+  ∀a, ∀b, a+b = b+a
+ -加法の単位元、逆元の存在
+  ∀a, 0+a = a
+  ∀a, ∃-a, a+(-a) = 0
+ -乗法の結合律、交換律
+  ∀a, ∀b, ∀c, a*(b*c) = (a*b)*c
+  ∀a, ∀b, a*b = b*a
+ -分配法則
+  ∀a, ∀b, ∀c, a*(b+c) = a*b+a*c
+ 以上の条件を満たす代数的構造 (可換環)
+
+ 以下のメンバを要求します
+ -value_type
+  台集合の型
+  size_type から static_cast で変換でき、
+  整数 n は 1 を n 個加算した値に変換される必要があります
+ -static plus (value_type, value_type)->value_type
+  2引数を取り、加算した結果を返す静的関数
+ -static minus (value_type, value_type)->value_type
+  2引数を取り、第1引数から第2引数を減算した結果を返す静的関数
+ -static times (value_type, value_type)->value_type
+  2引数を取り、乗算した結果を返す静的関数
+ -static zero ()->value_type
+  加法の単位元を返す静的関数
+
+-template <class> class Container
+ 型引数を1つ取り、それを要素とするコンテナ型
+ 内部実装で使用します
+
+
+メンバ型
+-value_structure
+ 構造の型 (CommutativeRing)
+
+-value_type
+ 要素となる台集合の型 (value_structure::value_type)
+
+-container_type
+ コンテナの型 (Container<::std::pair<value_type, value_type>>)
+
+-size_type
+ 符号なし整数型 (container_type::size_type)
+
+
+メンバ関数
+-(constructor) (size_type size)
+ size 個の要素からなる range_fenwick_tree を構築します
+ 各要素は 0 で初期化されます
+ 時間計算量 O(N)
+
+template<class InputIterator>
+-(constructor) (InputIterator first, InputIterator last)
+ [first, last) の要素から range_fenwick_tree を構築します
+ 時間計算量 O(N)
+
+-empty ()->bool
+ size()==0 と等価です
+ 時間計算量 O(1)
+
+-size ()->size_type
+ 要素数を返します
+ 時間計算量 O(1)
+
+-fold (size_type last)->value_type
+ [0, last) の和を返します
+ 時間計算量 O(logN)
+
+-fold (size_type first, size_type last)->value_type
+ [first, last) の和を返します
+ 時間計算量 O(logN)
+
+-add (size_type first, size_type last, const value_type &value)
+ [first, last) の各要素に value を加算します
+ 時間計算量 O(logN)
+
+
+※N:全体の要素数
+※value_structure の各関数の時間計算量を O(1) と仮定
+
+*/
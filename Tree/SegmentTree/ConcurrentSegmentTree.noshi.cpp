@@ -0,0 +1,251 @@
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <thread>
+#include <utility>
+
+template <class Monoid, template <class> class Container>
+class concurrent_segment_tree {
+public:
+  using value_structure = Monoid;
+  using value_type = typename value_structure::value_type;
+  using container_type = Container<value_type>;
+  using size_type = typename container_type::size_type;
+
+private:
+  static constexpr ::std::size_t stripes = 16;
+  class alignas(64) indicator {
+  public:
+    ::std::atomic<::std::size_t> count;
+  };
+
+  static size_type getsize(const size_type size) {
+    size_type ret = 1;
+    while (ret < size)
+      ret <<= 1;
+    return ret;
+  }
+  static ::std::size_t stripe() {
+    static ::std::atomic<::std::size_t> next(0);
+    thread_local const ::std::size_t ret = next++ % stripes;
+    return ret;
+  }
+
+  size_type size_;
+  container_type tree[2];
+  ::std::atomic<::std::size_t> current, version;
+  mutable indicator readers[2][stripes];
+
+  static void recalc(container_type &t, const size_type index) {
+    t[index] = value_structure::operation(t[index << 1], t[index << 1 | 1]);
+  }
+  void wait(const ::std::size_t v) const {
+    for (const indicator &r : readers[v])
+      while (r.count.load())
+        ::std::this_thread::yield();
+  }
+  template <class F> auto read(const F &f) const -> decltype(f(tree[0])) {
+    class guard {
+      ::std::atomic<::std::size_t> &count;
+
+    public:
+      explicit guard(::std::atomic<::std::size_t> &c) : count(c) { ++count; }
+      ~guard() { --count; }
+    };
+    const guard g(readers[version.load()][stripe()].count);
+    return f(tree[current.load()]);
+  }
+  template <class F> void write(const F &f) {
+    const ::std::size_t c = current.load(), v = version.load();
+    f(tree[c ^ 1]);
+    current.store(c ^ 1);
+    wait(v ^ 1);
+    version.store(v ^ 1);
+    wait(v);
+    f(tree[c]);
+  }
+
+public:
+  explicit concurrent_segment_tree(const size_type size = 0)
+      : size_(size),
+        tree{container_type(getsize(size) << 1, value_structure::identity()),
+             container_type(getsize(size) << 1, value_structure::identity())},
+        current(0), version(0), readers() {}
+  template <class InputIterator>
+  concurrent_segment_tree(InputIterator first, InputIterator last)
+      : size_(::std::distance(first, last)), tree(), current(0), version(0),
+        readers() {
+    const size_type cap = getsize(size_);
+    tree[0].reserve(cap << 1);
+    tree[0].resize(cap, value_structure::identity());
+    tree[0].insert(tree[0].end(), first, last);
+    tree[0].resize(cap << 1, value_structure::identity());
+    for (size_type i = cap - 1; i; --i)
+      recalc(tree[0], i);
+    tree[1] = tree[0];
+  }
+  concurrent_segment_tree(const concurrent_segment_tree &) = delete;
+  concurrent_segment_tree &operator=(const concurrent_segment_tree &) = delete;
+
+  bool empty() const { return !size_; }
+  size_type size() const { return size_; }
+
+  value_type operator[](const size_type index) const {
+    assert(index < size());
+    return read([index](const container_type &t) -> value_type {
+      return t[index + (t.size() >> 1)];
+    });
+  }
+  value_type fold(size_type first, size_type last) const {
+    assert(first <= last);
+    assert(first <= size());
+    assert(last <= size());
+    return read([first, last](const container_type &t) {
+      value_type ret_l = value_structure::identity(),
+                 ret_r = value_structure::identity();
+      for (size_type l = first + (t.size() >> 1), r = last + (t.size() >> 1);
+           l < r; l >>= 1, r >>= 1) {
+        if (l & 1)
+          ret_l = value_structure::operation(::std::move(ret_l), t[l++]);
+        if (r & 1)
+          ret_r = value_structure::operation(t[r - 1], ::std::move(ret_r));
+      }
+      return value_structure::operation(::std::move(ret_l),
+                                        ::std::move(ret_r));
+    });
+  }
+  template <class F> size_type search(const F &f) const {
+    if (f(value_structure::identity()))
+      return 0;
+    return read([this, &f](const container_type &t) {
+      const size_type base = t.size() >> 1;
+      if (!f(t[1]))
+        return size() + 1;
+      value_type acc = value_structure::identity();
+      size_type i = 1;
+      while (i < base)
+        if (!f(value_structure::operation(acc, t[i <<= 1])))
+          acc = value_structure::operation(::std::move(acc), t[i++]);
+      return i - base + 1;
+    });
+  }
+
+  template <class F> void update(size_type index, const F &f) {
+    assert(index < size());
+    index += tree[0].size() >> 1;
+    const value_type value = f(tree[current.load()][index]);
+    write([index, &value](container_type &t) {
+      t[index] = value;
+      for (size_type i = index >> 1; i; i >>= 1)
+        recalc(t, i);
+    });
+  }
+};
+
+/*
+
+template<class Monoid, template <class> class Container>
+class concurrent_segment_tree;
+
+concurrent_segment_tree は 1 つの書き込みスレッドと
+複数の読み込みスレッドから同時に使用できる segment_tree です
+木を 2 つ持ち、読み込みは片方のみを参照します
+書き込みは参照されていない方を更新してから参照先を切り替え、
+古い方を参照する読み込みが全て終わるのを待ってからもう片方を更新します
+(Left-Right 法)
+読み込みはロックを取らず、待機もしません
+各操作は線形化可能です
+読み込み中のスレッドの数は 16 個のカウンタに分けて数え、
+各カウンタを別々のキャッシュラインに配置します
+(new で確保する場合、C++17 以降か -faligned-new が必要です)
+空間計算量 O(N)
+
+
+テンプレートパラメータ
+-class Monoid
+ -結合律
+  ∀a, ∀b, ∀c, a·(b·c) = (a·b)·c
+ -単位元の存在
+  ∃e, ∀a, e·a = a·e = a
+ 以上の条件を満たす代数的構造 (モノイド)
+
+ 以下のメンバを要求します
+ -value_type
+  台集合の型
+ -static operation (value_type, value_type)->value_type
+  2引数を取り、演算した結果を返す静的関数
+ -static identity ()->value_type
+  単位元を返す静的関数
+
+-template <class> class Container
+ テンプレート引数を一つ取り、それを要素とするコンテナ型
+ 内部実装で使用します
+
+
+メンバ型
+-value_structure
+ 構造の型 (Monoid)
+
+-value_type
+ 要素となる台集合の型 (value_structure::value_type)
+
+-container_type
+ 内部で使用するコンテナの型 (Container<value_type>)
+
+-size_type
+ 符号なし整数型 (container_type::size_type)
+
+
+メンバ関数
+-(constructor) (size_type size = 0)
+ 要素数 size で concurrent_segment_tree を構築します
+ 各要素は単位元で初期化されます
+ 時間計算量 O(N)
+
+template<class InputIterator>
+-(constructor) (InputIterator first, InputIterator last)
+ [first, last) の要素から concurrent_segment_tree を構築します
+ 時間計算量 O(N)
+
+-empty ()->bool
+ size()==0 と同値です
+ 時間計算量 O(1)
+
+-size ()->size_type
+ 要素数を返します
+ 時間計算量 O(1)
+
+以下の関数は複数のスレッドから同時に呼び出すことができます
+
+-operator[] (size_type index)->value_type
+ 指定した要素の値を返します
+ 時間計算量 O(1)
+
+-fold (size_type first, size_type last)->value_type
+ [first, last) の和を返します
+ 時間計算量 O(logN)
+
+template<class F>
+-search (F f)->size_type
+ f(fold(0, i - 1)) が false を返し、
+ f(fold(0, i))     が true  を返すような i を返します
+ f(fold(0, -1))         は false、
+ f(fold(0, size() + 1)) は true と扱います
+ 時間計算量 O(logN)
+
+以下の関数は同時に 1 つのスレッドからのみ呼び出すことができます
+読み込みの関数とは同時に呼び出すことができます
+
+template<class F>
+-update (size_type index, F f)
+ 指定した要素を f を適用した値に変更します
+ f は 1 度だけ呼び出されます
+ 実行中の読み込みが終わるまで待機します
+ 時間計算量 O(logN)
+
+
+※N:全体の要素数
+※value_structure の各関数の時間計算量を O(1) と仮定
+
+*/
@@ -0,0 +1,212 @@
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+template <class Monoid> class dynamic_segment_tree {
+public:
+  using value_structure = Monoid;
+  using value_type = typename value_structure::value_type;
+  using size_type = ::std::uint_least64_t;
+
+private:
+  using index_type = ::std::uint_least32_t;
+  class node_type {
+  public:
+    value_type value;
+    index_type child[2];
+    node_type() : value(value_structure::identity()), child{0, 0} {}
+  };
+
+  static size_type getsize(const size_type size) {
+    size_type ret = 1;
+    while (ret < size)
+      ret <<= 1;
+    return ret;
+  }
+
+  size_type size_, base_size;
+  ::std::vector<node_type> pool;
+
+  index_type make_node() {
+    assert(pool.size() < static_cast<index_type>(-1));
+    pool.emplace_back();
+    return static_cast<index_type>(pool.size() - 1);
+  }
+  value_type fold(const index_type node, const size_type width,
+                  const size_type first, const size_type last) const {
+    if (!node || (first == 0 && last == width))
+      return pool[node].value;
+    const size_type half = width >> 1;
+    if (last <= half)
+      return fold(pool[node].child[0], half, first, last);
+    if (half <= first)
+      return fold(pool[node].child[1], half, first - half, last - half);
+    return value_structure::operation(
+        fold(pool[node].child[0], half, first, half),
+        fold(pool[node].child[1], half, 0, last - half));
+  }
+
+public:
+  explicit dynamic_segment_tree(const size_type size = 0)
+      : size_(size), base_size(), pool(2) {
+    assert(size <= static_cast<size_type>(1) << 63);
+    base_size = getsize(size);
+  }
+
+  bool empty() const { return !size_; }
+  size_type size() const { return size_; }
+  ::std::size_t node_count() const { return pool.size() - 2; }
+  void reserve(const ::std::size_t n) { pool.reserve(n + 2); }
+
+  value_type operator[](const size_type index) const {
+    assert(index < size());
+    index_type node = 1;
+    for (size_type k = base_size >> 1; node && k; k >>= 1)
+      node = pool[node].child[(index & k) != 0];
+    return pool[node].value;
+  }
+  value_type fold(const size_type first, const size_type last) const {
+    assert(first <= last);
+    assert(first <= size());
+    assert(last <= size());
+    if (first == last)
+      return value_structure::identity();
+    return fold(1, base_size, first, last);
+  }
+  template <class F> size_type search(const F &f) const {
+    if (f(value_structure::identity()))
+      return 0;
+    if (!f(pool[1].value))
+      return size() + 1;
+    value_type acc = value_structure::identity();
+    index_type node = 1;
+    size_type i = 0;
+    for (size_type k = base_size >> 1; k; k >>= 1) {
+      const node_type &n = pool[node];
+      if (!f(value_structure::operation(acc, pool[n.child[0]].value))) {
+        acc = value_structure::operation(::std::move(acc),
+                                         pool[n.child[0]].value);
+        node = n.child[1];
+        i |= k;
+      } else {
+        node = n.child[0];
+      }
+    }
+    return i + 1;
+  }
+
+  template <class F> void update(const size_type index, const F &f) {
+    assert(index < size());
+    index_type path[64];
+    ::std::size_t depth = 0;
+    index_type node = 1;
+    for (size_type k = base_size >> 1; k; k >>= 1) {
+      path[depth++] = node;
+      const bool d = (index & k) != 0;
+      if (!pool[node].child[d]) {
+        const index_type c = make_node();
+        pool[node].child[d] = c;
+      }
+      node = pool[node].child[d];
+    }
+    pool[node].value = f(::std::move(pool[node].value));
+    while (depth) {
+      node_type &n = pool[path[--depth]];
+      n.value = value_structure::operation(pool[n.child[0]].value,
+                                           pool[n.child[1]].value);
+    }
+  }
+};
+
+/*
+
+template<class Monoid>
+class dynamic_segment_tree;
+
+dynamic_segment_tree は必要な節点のみを生成する segment_tree です
+要素数が非常に大きく、変更される要素が少ない場合に使用します
+節点は 1 つの配列に確保し、子を 32 bit の添字で参照します
+空間計算量 O(QlogN)
+
+
+テンプレートパラメータ
+-class Monoid
+ -結合律
+  ∀a, ∀b, ∀c, a·(b·c) = (a·b)·c
+ -単位元の存在
+  ∃e, ∀a, e·a = a·e = a
+ 以上の条件を満たす代数的構造 (モノイド)
+
+ 以下のメンバを要求します
+ -value_type
+  台集合の型
+ -static operation (value_type, value_type)->value_type
+  2引数を取り、演算した結果を返す静的関数
+ -static identity ()->value_type
+  単位元を返す静的関数
+
+
+メンバ型
+-value_structure
+ 構造の型 (Monoid)
+
+-value_type
+ 要素となる台集合の型 (value_structure::value_type)
+
+-size_type
+ 符号なし整数型 (::std::uint_least64_t)
+
+
+メンバ関数
+-(constructor) (size_type size = 0)
+ 要素数 size で dynamic_segment_tree を構築します
+ 各要素は単位元で初期化されます
+ size は 2^63 以下である必要があります
+ 時間計算量 O(1)
+
+-empty ()->bool
+ size()==0 と同値です
+ 時間計算量 O(1)
+
+-size ()->size_type
+ 要素数を返します
+ 時間計算量 O(1)
+
+-node_count ()->::std::size_t
+ 生成した節点の数を返します
+ 時間計算量 O(1)
+
+-reserve (::std::size_t n)
+ n 個の節点を再確保なしで生成できるようにします
+ 時間計算量 O(n)
+
+-operator[] (size_type index)->value_type
+ 指定した要素の値を返します
+ 時間計算量 O(logN)
+
+-fold (size_type first, size_type last)->value_type
+ [first, last) の和を返します
+ 時間計算量 O(logN)
+
+template<class F>
+-search (F f)->size_type
+ f(fold(0, i - 1)) が false を返し、
+ f(fold(0, i))     が true  を返すような i を返します
+ f(fold(0, -1))         は false、
+ f(fold(0, size() + 1)) は true と扱います
+ 時間計算量 O(logN)
+
+template<class F>
+-update (size_type index, F f)
+ 指定した要素を f を適用した値に変更します
+ 生成される節点は高々 logN 個です
+ 節点の数が 2^32 - 1 を超えてはいけません
+ 時間計算量 O(logN)
+
+
+※N:全体の要素数
+※Q:update の呼び出し回数
+※value_structure の各関数の時間計算量を O(1) と仮定
+
+*/
@@ -13,79 +13,121 @@ struct LazyOperator {
   Func lazy_throw;
 };
 
-template <class Monoid>
+template <class Monoid, class Operator = LazyOperator<Monoid>>
 struct LazySegment {
-  using Func = function<Monoid(Monoid, Monoid)>;
-  vector<Monoid> node;
-  vector<Monoid> lazy;
-  vector<bool> lazyFlag;
+  struct Node {
+    Monoid value;
+    Monoid lazy;
+    bool flag;
+  };
+  vector<Node> node;
   int n;
+  int h;
   Monoid ide;
   Monoid lazy_init;
 
-  LazyOperator<Monoid> ope;
+  Operator ope;
 
   LazySegment(const vector<Monoid> init, Monoid ide_, Monoid lazy_i,
-              LazyOperator<Monoid> ope_)
-      : ope(ope_), ide(ide_), lazy_init(lazy_i) {
+              Operator ope_ = Operator())
+      : ide(ide_), lazy_init(lazy_i), ope(ope_) {
     n = 1;
+    h = 0;
     int sz = init.size();
-    while (n < sz) n *= 2;
+    while (n < sz) n *= 2, h++;
 
-    node.resize(n * 2 - 1, ide);
-    lazy.resize(n * 2 - 1, lazy_init);
-    lazyFlag.resize(n * 2 - 1, false);
+    node.assign(n * 2, Node{ide, lazy_init, false});
 
-    for (int i = 0; i < sz; i++) node[i + n - 1] = init[i];
-    for (int i = n - 2; i >= 0; i--)
-      node[i] = ope.node_update(node[i * 2 + 1], node[i * 2 + 2]);
+    for (int i = 0; i < sz; i++) node[i + n].value = init[i];
+    for (int i = n - 1; i >= 1; i--)
+      node[i].value = ope.node_update(node[i * 2].value, node[i * 2 + 1].value);
   }
 
-  void eval(int k, int l, int r) {
-    if (lazyFlag[k]) {
-      node[k] = ope.lazy_effect(node[k], lazy[k]);
-
-      if (r - l > 1) {
-        lazy[2 * k + 1] = ope.lazy_throw(lazy[k], lazy[2 * k + 1]);
-        lazy[2 * k + 2] = ope.lazy_throw(lazy[k], lazy[2 * k + 2]);
-        lazyFlag[2 * k + 1] = true;
-        lazyFlag[2 * k + 2] = true;
+  // k : 高さ d の頂点 , [(k << d) - n, ((k + 1) << d) - n) を担当する
+  void eval(int k, int d) {
+    Node &v = node[k];
+    if (v.flag) {
+      v.value = ope.lazy_effect(v.value, v.lazy);
+
+      if (d > 0) {
+        Node &lc = node[k * 2];
+        Node &rc = node[k * 2 + 1];
+        lc.lazy = ope.lazy_throw(v.lazy, lc.lazy);
+        rc.lazy = ope.lazy_throw(v.lazy, rc.lazy);
+        lc.flag = true;
+        rc.flag = true;
       }
 
-      lazyFlag[k] = false;
-      lazy[k] = lazy_init;
+      v.flag = false;
+      v.lazy = lazy_init;
     }
   }
 
-  void update_inter(int a, int b, Monoid x, int k = 0, int l = 0, int r = -1) {
-    if (r < 0) r = n;
-
-    eval(k, l, r);
+  void recalc(int k, int d) {
+    eval(k * 2, d - 1);
+    eval(k * 2 + 1, d - 1);
+    node[k].value = ope.node_update(node[k * 2].value, node[k * 2 + 1].value);
+  }
 
-    if (r <= a || b <= l) return;
+  void update_inter(int a, int b, Monoid x) {
+    if (a >= b) return;
+    a += n;
+    b += n;
 
-    if (a <= l && r <= b) {
-      lazy[k] = ope.lazy_make(l, r, x, lazy[k]);
-      lazyFlag[k] = true;
-      eval(k, l, r);
-    } else {
-      update_inter(a, b, x, k * 2 + 1, l, (l + r) / 2);
-      update_inter(a, b, x, k * 2 + 2, (l + r) / 2, r);
-      node[k] = ope.node_update(node[k * 2 + 1], node[k * 2 + 2]);
+    for (int d = h; d >= 1; d--) {
+      eval(a >> d, d);
+      eval((b - 1) >> d, d);
     }
-  }
 
-  Monoid get_inter(int a, int b, int k = 0, int l = 0, int r = -1) {
-    if (r < 0) r = n;
+    for (int l = a, r = b, d = 0; l < r; l >>= 1, r >>= 1, d++) {
+      if (l & 1) {
+        eval(l, d);
+        node[l].lazy =
+            ope.lazy_make((l << d) - n, ((l + 1) << d) - n, x, node[l].lazy);
+        node[l].flag = true;
+        eval(l, d);
+        l++;
+      }
+      if (r & 1) {
+        r--;
+        eval(r, d);
+        node[r].lazy =
+            ope.lazy_make((r << d) - n, ((r + 1) << d) - n, x, node[r].lazy);
+        node[r].flag = true;
+        eval(r, d);
+      }
+    }
 
-    eval(k, l, r);
+    for (int d = 1; d <= h; d++) {
+      if (((a >> d) << d) != a) recalc(a >> d, d);
+      if (((b >> d) << d) != b) recalc((b - 1) >> d, d);
+    }
+  }
 
-    if (r <= a || b <= l) return ide;
+  Monoid get_inter(int a, int b) {
+    if (a >= b) return ide;
+    a += n;
+    b += n;
 
-    if (a <= l && r <= b) return node[k];
+    for (int d = h; d >= 1; d--) {
+      eval(a >> d, d);
+      eval((b - 1) >> d, d);
+    }
 
-    Monoid lm = get_inter(a, b, k * 2 + 1, l, (l + r) / 2);
-    Monoid rm = get_inter(a, b, k * 2 + 2, (l + r) / 2, r);
+    Monoid lm = ide;
+    Monoid rm = ide;
+    for (int l = a, r = b, d = 0; l < r; l >>= 1, r >>= 1, d++) {
+      if (l & 1) {
+        eval(l, d);
+        lm = ope.node_update(lm, node[l].value);
+        l++;
+      }
+      if (r & 1) {
+        r--;
+        eval(r, d);
+        rm = ope.node_update(node[r].value, rm);
+      }
+    }
     return ope.node_update(lm, rm);
   }
 };
@@ -116,4 +158,11 @@ lazy_effect(Monoid node,Monoid lazy)
 
 lazy_throw(Monoid gen , Monoid throw_lazy)
     genが投げる先、throw_lazyが投げる遅延
-*/
\ No newline at end of file
+
+Operator
+    LazyOperator と同じ名前のメンバ関数を持つ型
+    デフォルトは LazyOperator<Monoid> (std::function 経由で呼び出す)
+    関数オブジェクトの型を直接与えると各演算がインライン化される
+
+update_inter , get_inter は再帰を使わず, 葉から根へ向かって計算する
+*/
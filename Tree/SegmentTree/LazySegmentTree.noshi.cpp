@@ -1,7 +1,11 @@
+#include <algorithm>
 #include <cassert>
 #include <iterator>
 #include <stdexcept>
+#include <thread>
+#include <tuple>
 #include <utility>
+#include <vector>
 
 template <class ValueMonoid, class OperatorMonoid, class Modifier,
           template <class> class Container>
@@ -13,39 +17,64 @@ public:
   using operator_structure = OperatorMonoid;
   using operator_type = typename operator_structure::value_type;
   using modifier = Modifier;
-  using container_type = Container<::std::pair<value_type, operator_type>>;
+  using container_type = Container<value_type>;
+  using operator_container_type = Container<operator_type>;
   using size_type = typename container_type::size_type;
 
 private:
   size_type size_, height;
   container_type tree;
+  operator_container_type lazy;
   static size_type getheight(const size_type size) noexcept {
     size_type ret = 0;
     while (static_cast<size_type>(1) << ret < size)
       ++ret;
     return ret;
   }
-  static value_type reflect(typename container_type::const_reference element) {
-    return modifier::operation(element.first, element.second);
+  template <class T>
+  static auto identity_test(const operator_type &element, int)
+      -> decltype(static_cast<bool>(T::is_identity(element))) {
+    return static_cast<bool>(T::is_identity(element));
+  }
+  template <class T>
+  static auto identity_test(const operator_type &element, long)
+      -> decltype(static_cast<bool>(element == T::identity())) {
+    return static_cast<bool>(element == T::identity());
+  }
+  template <class T>
+  static bool identity_test(const operator_type &, ...) {
+    return false;
+  }
+  static bool is_identity(const operator_type &element) {
+    return identity_test<operator_structure>(element, 0);
+  }
+  value_type reflect(const size_type index) const {
+    if (is_identity(lazy[index]))
+      return tree[index];
+    return modifier::operation(tree[index], lazy[index]);
   }
   void recalc(const size_type index) {
-    tree[index].first = value_structure::operation(
-        reflect(tree[index << 1]), reflect(tree[index << 1 | 1]));
+    tree[index] = value_structure::operation(reflect(index << 1),
+                                             reflect(index << 1 | 1));
   }
   static void assign(operator_type &element, const operator_type &data) {
     element = operator_structure::operation(element, data);
   }
   void push(const size_type index) {
-    assign(tree[index << 1].second, tree[index].second);
-    assign(tree[index << 1 | 1].second, tree[index].second);
-    tree[index].second = operator_structure::identity();
+    if (is_identity(lazy[index]))
+      return;
+    assign(lazy[index << 1], lazy[index]);
+    assign(lazy[index << 1 | 1], lazy[index]);
+    lazy[index] = operator_structure::identity();
   }
   void propagate(const size_type index) {
     for (size_type i = height; i; --i)
       push(index >> i);
   }
   void thrust(const size_type index) {
-    tree[index].first = reflect(tree[index]);
+    if (is_identity(lazy[index]))
+      return;
+    tree[index] = modifier::operation(tree[index], lazy[index]);
     push(index);
   }
   void evaluate(const size_type index) {
@@ -57,26 +86,63 @@ private:
       recalc(index);
   }
   size_type base_size() const { return static_cast<size_type>(1) << height; }
+  void construct(const size_type threads) {
+    const size_type cap = base_size();
+    size_type roots = 1;
+    while (roots < threads && roots < cap)
+      roots <<= 1;
+    if (roots == 1) {
+      roots = cap;
+    } else {
+      ::std::vector<::std::thread> workers;
+      for (size_type t = 0; t != threads; ++t) {
+        const size_type lo = roots + roots * t / threads,
+                        hi = roots + roots * (t + 1) / threads;
+        if (lo == hi)
+          continue;
+        workers.emplace_back([this, cap, lo, hi] {
+          size_type l = lo, r = hi;
+          while (l < cap)
+            l <<= 1, r <<= 1;
+          while (l != lo) {
+            l >>= 1;
+            r >>= 1;
+            for (size_type i = r; i-- != l;)
+              recalc(i);
+          }
+        });
+      }
+      for (auto &w : workers)
+        w.join();
+    }
+    for (size_type i = roots - 1; i; --i)
+      recalc(i);
+  }
 
 public:
-  lazy_segment_tree() : size_(0), height(0), tree() {}
+  lazy_segment_tree() : size_(0), height(0), tree(), lazy() {}
   explicit lazy_segment_tree(const size_type size)
       : size_(size), height(getheight(size_)),
         tree(static_cast<size_type>(1) << (height + 1),
-             {value_structure::identity(), operator_structure::identity()}) {}
+             value_structure::identity()),
+        lazy(static_cast<size_type>(1) << (height + 1),
+             operator_structure::identity()) {}
   template <class InputIterator>
   explicit lazy_segment_tree(InputIterator first, InputIterator last)
-      : size_(::std::distance(first, last)), height(getheight(size_)), tree() {
+      : lazy_segment_tree(first, last, 1) {}
+  template <class InputIterator>
+  lazy_segment_tree(InputIterator first, InputIterator last,
+                    const size_type threads)
+      : size_(::std::distance(first, last)), height(getheight(size_)), tree(),
+        lazy(static_cast<size_type>(2) << height,
+             operator_structure::identity()) {
     const size_type cap = static_cast<size_type>(1) << height;
     tree.reserve(cap << 1);
-    tree.resize(cap,
-                {value_structure::identity(), operator_structure::identity()});
+    tree.resize(cap, value_structure::identity());
     for (; first != last; ++first)
-      tree.emplace_back(*first, operator_structure::identity());
-    tree.resize(cap << 1,
-                {value_structure::identity(), operator_structure::identity()});
-    for (size_type i = cap - 1; i; --i)
-      recalc(i);
+      tree.emplace_back(*first);
+    tree.resize(cap << 1, value_structure::identity());
+    construct(threads);
   }
 
   bool empty() const { return !size_; }
@@ -86,9 +152,9 @@ public:
     assert(index < size());
     index += base_size();
     evaluate(index);
-    tree[index].first = reflect(tree[index]);
-    tree[index].second = operator_structure::identity();
-    return tree[index].first;
+    tree[index] = reflect(index);
+    lazy[index] = operator_structure::identity();
+    return tree[index];
   }
   const_reference at(size_type index) {
     if (index < size()) {
@@ -96,9 +162,9 @@ public:
     } else {
       index += base_size();
       evaluate(index);
-      tree[index].first = reflect(tree[index]);
-      tree[index].second = operator_structure::identity();
-      return tree[index].first;
+      tree[index] = reflect(index);
+      lazy[index] = operator_structure::identity();
+      return tree[index];
     }
   }
   value_type fold(size_type first, size_type last) {
@@ -113,33 +179,81 @@ public:
                ret_r = value_structure::identity();
     for (; first < last; first >>= 1, last >>= 1) {
       if (first & 1)
-        ret_l = value_structure::operation(ret_l, reflect(tree[first++]));
+        ret_l = value_structure::operation(ret_l, reflect(first++));
       if (last & 1)
-        ret_r = value_structure::operation(reflect(tree[last - 1]), ret_r);
+        ret_r = value_structure::operation(reflect(last - 1), ret_r);
     }
     return value_structure::operation(ret_l, ret_r);
   }
   template <class F> size_type search(const F &f) {
     if (f(value_structure::identity()))
       return static_cast<size_type>(0);
-    if (!f(reflect(tree[1])))
+    if (!f(reflect(1)))
       return size() + 1;
     value_type acc = value_structure::identity();
     size_type i = 1;
     while (i < base_size()) {
       thrust(i);
-      if (!f(value_structure::operation(acc, reflect(tree[i <<= 1]))))
-        acc = value_structure::operation(acc, reflect(tree[i++]));
+      if (!f(value_structure::operation(acc, reflect(i <<= 1))))
+        acc = value_structure::operation(acc, reflect(i++));
     }
     return i - base_size() + 1;
   }
+  template <class F> size_type max_right(size_type first, const F &f) {
+    assert(first <= size());
+    assert(f(value_structure::identity()));
+    if (first == size())
+      return size();
+    first += base_size();
+    evaluate(first);
+    value_type acc = value_structure::identity();
+    do {
+      while (!(first & 1))
+        first >>= 1;
+      if (!f(value_structure::operation(acc, reflect(first)))) {
+        while (first < base_size()) {
+          thrust(first);
+          if (f(value_structure::operation(acc, reflect(first <<= 1))))
+            acc = value_structure::operation(acc, reflect(first++));
+        }
+        return first - base_size();
+      }
+      acc = value_structure::operation(acc, reflect(first++));
+    } while (first & (first - 1));
+    return size();
+  }
+  template <class F> size_type min_left(size_type last, const F &f) {
+    assert(last <= size());
+    assert(f(value_structure::identity()));
+    if (last == 0)
+      return 0;
+    last += base_size();
+    evaluate(last - 1);
+    value_type acc = value_structure::identity();
+    do {
+      --last;
+      while (last > 1 && (last & 1))
+        last >>= 1;
+      if (!f(value_structure::operation(reflect(last), acc))) {
+        while (last < base_size()) {
+          thrust(last);
+          last = last << 1 | 1;
+          if (f(value_structure::operation(reflect(last), acc)))
+            acc = value_structure::operation(reflect(last--), acc);
+        }
+        return last + 1 - base_size();
+      }
+      acc = value_structure::operation(reflect(last), acc);
+    } while (last & (last - 1));
+    return 0;
+  }
 
   template <class F> void update(size_type index, const F &f) {
     assert(index < size());
     index += base_size();
     propagate(index);
-    tree[index].first = f(reflect(tree[index]));
-    tree[index].second = operator_structure::identity();
+    tree[index] = f(reflect(index));
+    lazy[index] = operator_structure::identity();
     build(index);
   }
   void update(size_type first, size_type last, const operator_type &data) {
@@ -153,13 +267,48 @@ public:
     for (size_type left = first, right = last; left < right;
          left >>= 1, right >>= 1) {
       if (left & 1)
-        assign(tree[left++].second, data);
+        assign(lazy[left++], data);
       if (right & 1)
-        assign(tree[right - 1].second, data);
+        assign(lazy[right - 1], data);
     }
     build(first);
     build(last - 1);
   }
+  template <class InputIterator>
+  void update_batch(InputIterator first, InputIterator last) {
+    ::std::vector<size_type> dirty;
+    for (; first != last; ++first) {
+      size_type l = ::std::get<0>(*first), r = ::std::get<1>(*first);
+      assert(l <= r);
+      assert(r <= size());
+      if (l == r)
+        continue;
+      l += base_size();
+      r += base_size();
+      propagate(l);
+      propagate(r - 1);
+      dirty.push_back(l >> 1);
+      dirty.push_back((r - 1) >> 1);
+      const operator_type data = ::std::get<2>(*first);
+      for (; l < r; l >>= 1, r >>= 1) {
+        if (l & 1)
+          assign(lazy[l++], data);
+        if (r & 1)
+          assign(lazy[r - 1], data);
+      }
+    }
+    ::std::sort(dirty.begin(), dirty.end());
+    dirty.erase(::std::unique(dirty.begin(), dirty.end()), dirty.end());
+    while (!dirty.empty() && dirty.front()) {
+      size_type len = 0;
+      for (const size_type index : dirty) {
+        recalc(index);
+        if (!len || dirty[len - 1] != index >> 1)
+          dirty[len++] = index >> 1;
+      }
+      dirty.resize(len);
+    }
+  }
 };
 
 /*
@@ -173,6 +322,8 @@ template<class ValueMonoid, class OperatorMonoid, class Modify,
          class lazy_segment_tree;
 
 lazy_segment_tree はモノイドの区間和と区間更新を高速に計算するデータ構造です
+要素と作用は別々の配列に保持し、fold が作用を持たない節点を読むときは
+要素の配列のみを参照します
 空間計算量 O(N)
 
 
@@ -207,6 +358,13 @@ lazy_segment_tree はモノイドの区間和と区間更新を高速に計算
  -static identity ()->value_type
   単位元を返す静的関数
 
+ 以下のメンバは任意です
+ -static is_identity (value_type)->bool
+  引数が単位元であるかを返す静的関数
+  存在しない場合、value_type が == で比較可能ならば identity() との比較で
+  判定し、いずれでもなければ常に false とみなします
+  単位元である作用を持つ節点では、子への伝播と作用の計算を省略します
+
 -class Modify
  (ValueMonoid の台集合を V、OperatorMonoid の台集合を O、Modify を m と表記)
  -閉性
@@ -244,7 +402,10 @@ lazy_segment_tree はモノイドの区間和と区間更新を高速に計算
  演算要素の型 (operator_structure::value_type)
 
 -container_type
- 内部実装のコンテナ型 (Container<::std::pair<value_type, operator_type>>)
+ 要素を保持する内部実装のコンテナ型 (Container<value_type>)
+
+-operator_container_type
+ 作用を保持する内部実装のコンテナ型 (Container<operator_type>)
 
 -size_type
  符号なし整数型 (container_type::size_type)
@@ -261,6 +422,13 @@ template<class InputIterator>
  [first, last) の要素から lazy_segment_tree を構築します
  時間計算量 O(N)
 
+template<class InputIterator>
+-(constructor) (InputIterator first, InputIterator last, size_type threads)
+ [first, last) の要素から lazy_segment_tree を構築します
+ 内部節点の計算を threads 個のスレッドで部分木ごとに分担し、
+ 根に近い段のみを逐次に計算します
+ 時間計算量 O(N/P + P)
+
 
 -empty ()->bool
  size()==0 と同値です
@@ -292,6 +460,22 @@ template<class F>
  f(fold(0, size() + 1)) は true と扱います
  時間計算量 O(logN)
 
+template<class F>
+-max_right (size_type first, F f)->size_type
+ f(fold(first, i)) が true を返すような最大の i を返します
+ f(単位元) は true である必要があり、
+ f(fold(first, i)) が false ならば f(fold(first, i + 1)) も false である
+ 必要があります
+ 時間計算量 O(logN)
+
+template<class F>
+-min_left (size_type last, F f)->size_type
+ f(fold(i, last)) が true を返すような最小の i を返します
+ f(単位元) は true である必要があり、
+ f(fold(i, last)) が false ならば f(fold(i - 1, last)) も false である
+ 必要があります
+ 時間計算量 O(logN)
+
 template<class F>
 -update (size_type index, F f)
  index で指定した要素を f を適用した値で更新します
@@ -301,8 +485,18 @@ template<class F>
  [first, last) に data を作用させます
  時間計算量 O(logN)
 
+template<class InputIterator>
+-update_batch (InputIterator first, InputIterator last)
+ [first, last) の各要素 (l, r, data) について、先頭から順に
+ update(l, r, data) と同じ変更を行います
+ 祖先の再計算は全ての変更の後に 1 段ずつまとめて行い、
+ 共通の祖先は 1 度だけ再計算します
+ 時間計算量 O(KlogK + KlogN)
+
 
 ※N:全体の要素数
+※K:変更の数
+※P:スレッドの数
 ※各種関数の時間計算量を O(1) と仮定
 
 */
@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+template <class CommutativeMonoid, class Key> class offline_segment_tree_2d {
+public:
+  using value_structure = CommutativeMonoid;
+  using value_type = typename value_structure::value_type;
+  using const_reference = const value_type &;
+  using key_type = Key;
+  using size_type = ::std::size_t;
+
+private:
+  size_type size_, cap;
+  ::std::vector<key_type> xs;
+  ::std::vector<::std::vector<key_type>> ys;
+  ::std::vector<::std::vector<size_type>> where;
+  ::std::vector<::std::vector<value_type>> tree;
+
+  static void recalc(::std::vector<value_type> &t, const size_type index) {
+    t[index] = value_structure::operation(t[index << 1], t[index << 1 | 1]);
+  }
+  value_type fold_node(const size_type index, const size_type level,
+                       const key_type &y_first, const key_type &y_last) const {
+    const size_type b = (index << level) - cap;
+    if (b >= size_)
+      return value_structure::identity();
+    const size_type e = ::std::min(b + (static_cast<size_type>(1) << level),
+                                   size_);
+    const ::std::vector<key_type> &y = ys[level];
+    const ::std::vector<value_type> &t = tree[level];
+    size_type first = ::std::lower_bound(y.begin() + b, y.begin() + e,
+                                         y_first) - y.begin(),
+              last = ::std::lower_bound(y.begin() + first, y.begin() + e,
+                                        y_last) - y.begin();
+    value_type ret = value_structure::identity();
+    for (first += cap, last += cap; first < last; first >>= 1, last >>= 1) {
+      if (first & 1)
+        ret = value_structure::operation(::std::move(ret), t[first++]);
+      if (last & 1)
+        ret = value_structure::operation(::std::move(ret), t[--last]);
+    }
+    return ret;
+  }
+
+public:
+  offline_segment_tree_2d() : size_(0), cap(1), xs(), ys(), where(), tree() {}
+  template <class InputIterator>
+  offline_segment_tree_2d(InputIterator first, InputIterator last)
+      : size_(0), cap(1), xs(), ys(), where(), tree() {
+    ::std::vector<key_type> x, y;
+    ::std::vector<value_type> value;
+    for (; first != last; ++first) {
+      x.push_back(::std::get<0>(*first));
+      y.push_back(::std::get<1>(*first));
+      value.push_back(::std::get<2>(*first));
+    }
+    size_ = x.size();
+    size_type levels = 1;
+    while (cap < size_)
+      cap <<= 1, ++levels;
+    ::std::vector<size_type> ids(size_);
+    for (size_type i = 0; i != size_; ++i)
+      ids[i] = i;
+    ::std::stable_sort(ids.begin(), ids.end(),
+                       [&x](const size_type l, const size_type r) {
+                         return x[l] < x[r];
+                       });
+    xs.reserve(size_);
+    for (const size_type id : ids)
+      xs.push_back(x[id]);
+    ys.resize(levels);
+    where.resize(levels);
+    tree.resize(levels);
+    for (size_type h = 0; h != levels; ++h) {
+      const size_type w = static_cast<size_type>(1) << h;
+      if (h)
+        for (size_type b = 0; b + (w >> 1) < size_; b += w)
+          ::std::inplace_merge(ids.begin() + b, ids.begin() + b + (w >> 1),
+                               ids.begin() + ::std::min(b + w, size_),
+                               [&y](const size_type l, const size_type r) {
+                                 return y[l] < y[r];
+                               });
+      ys[h].reserve(size_);
+      where[h].resize(size_);
+      tree[h].assign(cap << 1, value_structure::identity());
+      for (size_type p = 0; p != size_; ++p) {
+        ys[h].push_back(y[ids[p]]);
+        where[h][ids[p]] = p;
+        tree[h][cap + p] = value[ids[p]];
+      }
+      for (size_type i = cap - 1; i; --i)
+        recalc(tree[h], i);
+    }
+  }
+
+  bool empty() const { return !size_; }
+  size_type size() const { return size_; }
+
+  const_reference operator[](const size_type index) const {
+    assert(index < size());
+    return tree[0][cap + where[0][index]];
+  }
+  value_type fold(const key_type &x_first, const key_type &x_last,
+                  const key_type &y_first, const key_type &y_last) const {
+    size_type first = ::std::lower_bound(xs.begin(), xs.end(), x_first) -
+                      xs.begin(),
+              last = ::std::lower_bound(xs.begin(), xs.end(), x_last) -
+                     xs.begin();
+    value_type ret = value_structure::identity();
+    size_type h = 0;
+    for (first += cap, last += cap; first < last;
+         first >>= 1, last >>= 1, ++h) {
+      if (first & 1)
+        ret = value_structure::operation(
+            ::std::move(ret), fold_node(first++, h, y_first, y_last));
+      if (last & 1)
+        ret = value_structure::operation(
+            ::std::move(ret), fold_node(--last, h, y_first, y_last));
+    }
+    return ret;
+  }
+
+  template <class F> void update(const size_type index, const F &f) {
+    assert(index < size());
+    const value_type value = f(tree[0][cap + where[0][index]]);
+    for (size_type h = 0; h != tree.size(); ++h) {
+      size_type i = cap + where[h][index];
+      tree[h][i] = value;
+      while (i >>= 1)
+        recalc(tree[h], i);
+    }
+  }
+};
+
+/*
+
+template<class CommutativeMonoid, class Key>
+class offline_segment_tree_2d;
+
+offline_segment_tree_2d は平面上の点に可換モノイドの値を持たせ、
+長方形領域に含まれる点の値の和を高速に計算するデータ構造です
+点の集合は構築時に与え、以後は値のみを変更できます
+点を x 座標順に並べた segment_tree の各段について、
+各節点の区間の点を y 座標順に並べた配列と、その上の segment_tree を持ちます
+座標の範囲によらず、点の数のみに依存する量のメモリを使用します
+空間計算量 O(NlogN)
+
+
+テンプレートパラメータ
+-class CommutativeMonoid
+ -結合律
+  ∀a, ∀b, ∀c, a·(b·c) = (a·b)·c
+ -交換律
+  ∀a, ∀b, a·b = b·a
+ -単位元の存在
+  ∃e, ∀a, e·a = a·e = a
+ 以上の条件を満たす代数的構造 (可換モノイド)
+
+ 以下のメンバを要求します
+ -value_type
+  台集合の型
+ -static operation (value_type, value_type)->value_type
+  2引数を取り、演算した結果を返す静的関数
+ -static identity ()->value_type
+  単位元を返す静的関数
+
+-class Key
+ 座標の型
+ < で全順序が定まっている必要があります
+
+
+メンバ型
+-value_structure
+ 構造の型 (CommutativeMonoid)
+
+-value_type
+ 要素となる台集合の型 (value_structure::value_type)
+
+-const_reference
+ 要素へのconst参照型 (const value_type &)
+
+-key_type
+ 座標の型 (Key)
+
+-size_type
+ 符号なし整数型 (::std::size_t)
+
+
+メンバ関数
+template<class InputIterator>
+-(constructor) (InputIterator first, InputIterator last)
+ [first, last) の各要素 (x, y, value) を、座標 (x, y) に値 value を持つ点として
+ offline_segment_tree_2d を構築します
+ 同じ座標の点が複数あっても構いません
+ 点には [first, last) での順に 0 から番号が付けられます
+ 時間計算量 O(NlogN)
+
+-empty ()->bool
+ size()==0 と同値です
+ 時間計算量 O(1)
+
+-size ()->size_type
+ 点の数を返します
+ 時間計算量 O(1)
+
+-operator[] (size_type index)->const_reference
+ 番号 index の点の値にアクセスします
+ 時間計算量 O(1)
+
+-fold (key_type x_first, key_type x_last, key_type y_first, key_type y_last)
+ ->value_type
+ x_first <= x < x_last かつ y_first <= y < y_last を満たす点の値の和を
+ 返します
+ 時間計算量 O(log^2N)
+
+template<class F>
+-update (size_type index, F f)
+ 番号 index の点の値を f を適用した値に変更します
+ f は 1 度だけ呼び出されます
+ 時間計算量 O(log^2N)
+
+
+※N:点の数
+※value_structure の各関数の時間計算量を O(1) と仮定
+
+*/
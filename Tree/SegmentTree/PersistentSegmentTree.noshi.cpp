@@ -0,0 +1,285 @@
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+template <class Monoid> class persistent_segment_tree {
+public:
+  using value_structure = Monoid;
+  using value_type = typename value_structure::value_type;
+  using size_type = ::std::size_t;
+  using version_type = ::std::uint_least32_t;
+
+private:
+  class node_type {
+  public:
+    value_type value;
+    version_type child[2];
+    node_type() : value(value_structure::identity()), child{0, 0} {}
+    node_type(value_type v, const version_type l, const version_type r)
+        : value(::std::move(v)), child{l, r} {}
+  };
+
+  static size_type getsize(const size_type size) {
+    size_type ret = 1;
+    while (ret < size)
+      ret <<= 1;
+    return ret;
+  }
+
+  size_type size_, base_size;
+  ::std::vector<node_type> pool;
+
+  version_type make_node(const version_type l, const version_type r) {
+    assert(pool.size() < static_cast<version_type>(-1));
+    pool.emplace_back(
+        value_structure::operation(pool[l].value, pool[r].value), l, r);
+    return static_cast<version_type>(pool.size() - 1);
+  }
+  version_type make_leaf(value_type value) {
+    assert(pool.size() < static_cast<version_type>(-1));
+    pool.emplace_back(::std::move(value), 0, 0);
+    return static_cast<version_type>(pool.size() - 1);
+  }
+  template <class InputIterator>
+  version_type build(const size_type width, InputIterator &first,
+                     const InputIterator &last) {
+    if (first == last)
+      return 0;
+    if (width == 1)
+      return make_leaf(*first++);
+    const version_type l = build(width >> 1, first, last);
+    const version_type r = build(width >> 1, first, last);
+    return make_node(l, r);
+  }
+  value_type fold(const version_type node, const size_type width,
+                  const size_type first, const size_type last) const {
+    if (!node || (first == 0 && last == width))
+      return pool[node].value;
+    const size_type half = width >> 1;
+    if (last <= half)
+      return fold(pool[node].child[0], half, first, last);
+    if (half <= first)
+      return fold(pool[node].child[1], half, first - half, last - half);
+    return value_structure::operation(
+        fold(pool[node].child[0], half, first, half),
+        fold(pool[node].child[1], half, 0, last - half));
+  }
+  version_type copy(::std::vector<node_type> &next,
+                    ::std::vector<version_type> &map,
+                    const version_type node) const {
+    if (!node || map[node])
+      return map[node];
+    const version_type l = copy(next, map, pool[node].child[0]);
+    const version_type r = copy(next, map, pool[node].child[1]);
+    next.emplace_back(pool[node].value, l, r);
+    return map[node] = static_cast<version_type>(next.size() - 1);
+  }
+
+public:
+  explicit persistent_segment_tree(const size_type size = 0)
+      : size_(size), base_size(getsize(size)), pool(1) {}
+
+  bool empty() const { return !size_; }
+  size_type size() const { return size_; }
+  size_type node_count() const { return pool.size() - 1; }
+  void reserve(const size_type n) { pool.reserve(n + 1); }
+
+  static constexpr version_type initial() { return 0; }
+  template <class InputIterator>
+  version_type build(InputIterator first, const InputIterator last) {
+    const version_type ret = build(base_size, first, last);
+    assert(first == last);
+    return ret;
+  }
+
+  value_type get(const version_type version, const size_type index) const {
+    assert(version < pool.size());
+    assert(index < size());
+    version_type node = version;
+    for (size_type k = base_size >> 1; node && k; k >>= 1)
+      node = pool[node].child[(index & k) != 0];
+    return pool[node].value;
+  }
+  value_type fold(const version_type version, const size_type first,
+                  const size_type last) const {
+    assert(version < pool.size());
+    assert(first <= last);
+    assert(first <= size());
+    assert(last <= size());
+    if (first == last)
+      return value_structure::identity();
+    return fold(version, base_size, first, last);
+  }
+  template <class F>
+  size_type search(const version_type version, const F &f) const {
+    assert(version < pool.size());
+    if (f(value_structure::identity()))
+      return 0;
+    if (!f(pool[version].value))
+      return size() + 1;
+    value_type acc = value_structure::identity();
+    version_type node = version;
+    size_type i = 0;
+    for (size_type k = base_size >> 1; k; k >>= 1) {
+      const node_type &n = pool[node];
+      if (!f(value_structure::operation(acc, pool[n.child[0]].value))) {
+        acc = value_structure::operation(::std::move(acc),
+                                         pool[n.child[0]].value);
+        node = n.child[1];
+        i |= k;
+      } else {
+        node = n.child[0];
+      }
+    }
+    return i + 1;
+  }
+
+  template <class F>
+  version_type update(const version_type version, const size_type index,
+                      const F &f) {
+    assert(version < pool.size());
+    assert(index < size());
+    version_type path[64];
+    size_type depth = 0;
+    version_type node = version;
+    for (size_type k = base_size >> 1; k; k >>= 1) {
+      path[depth++] = node;
+      node = pool[node].child[(index & k) != 0];
+    }
+    node = make_leaf(f(pool[node].value));
+    for (size_type k = 1; depth; k <<= 1) {
+      const node_type &n = pool[path[--depth]];
+      version_type child[2] = {n.child[0], n.child[1]};
+      child[(index & k) != 0] = node;
+      node = make_node(child[0], child[1]);
+    }
+    return node;
+  }
+
+  template <class ForwardIterator>
+  void compact(const ForwardIterator first, const ForwardIterator last) {
+    ::std::vector<node_type> next(1);
+    ::std::vector<version_type> map(pool.size(), 0);
+    for (ForwardIterator itr = first; itr != last; ++itr)
+      copy(next, map, *itr);
+    for (ForwardIterator itr = first; itr != last; ++itr)
+      *itr = map[*itr];
+    pool = ::std::move(next);
+  }
+};
+
+/*
+
+template<class Monoid>
+class persistent_segment_tree;
+
+persistent_segment_tree は変更前の状態 (版) を保持する segment_tree です
+update は変更された経路の節点のみを複製し、新しい版を返します
+節点は 1 つの配列に確保し、子を 32 bit の添字で参照します
+空間計算量 O(N + QlogN)
+
+
+テンプレートパラメータ
+-class Monoid
+ -結合律
+  ∀a, ∀b, ∀c, a·(b·c) = (a·b)·c
+ -単位元の存在
+  ∃e, ∀a, e·a = a·e = a
+ 以上の条件を満たす代数的構造 (モノイド)
+
+ 以下のメンバを要求します
+ -value_type
+  台集合の型
+ -static operation (value_type, value_type)->value_type
+  2引数を取り、演算した結果を返す静的関数
+ -static identity ()->value_type
+  単位元を返す静的関数
+
+
+メンバ型
+-value_structure
+ 構造の型 (Monoid)
+
+-value_type
+ 要素となる台集合の型 (value_structure::value_type)
+
+-size_type
+ 符号なし整数型 (::std::size_t)
+
+-version_type
+ 版を表す符号なし整数型 (::std::uint_least32_t)
+
+
+メンバ関数
+-(constructor) (size_type size = 0)
+ 要素数 size の persistent_segment_tree を構築します
+ 時間計算量 O(1)
+
+-empty ()->bool
+ size()==0 と同値です
+ 時間計算量 O(1)
+
+-size ()->size_type
+ 要素数を返します
+ 時間計算量 O(1)
+
+-node_count ()->size_type
+ 生成した節点の数を返します
+ 時間計算量 O(1)
+
+-reserve (size_type n)
+ n 個の節点を再確保なしで生成できるようにします
+ 時間計算量 O(n)
+
+-static initial ()->version_type
+ 全ての要素が単位元である版を返します
+ この版は常に有効です
+ 時間計算量 O(1)
+
+template<class InputIterator>
+-build (InputIterator first, InputIterator last)->version_type
+ [first, last) の要素からなる版を作成して返します
+ 要素数は size() 以下である必要があり、残りの要素は単位元となります
+ 時間計算量 O(N)
+
+-get (version_type version, size_type index)->value_type
+ 版 version の index で指定した要素の値を返します
+ 時間計算量 O(logN)
+
+-fold (version_type version, size_type first, size_type last)->value_type
+ 版 version の [first, last) の和を返します
+ 時間計算量 O(logN)
+
+template<class F>
+-search (version_type version, F f)->size_type
+ 版 version について
+ f(fold(0, i - 1)) が false を返し、
+ f(fold(0, i))     が true  を返すような i を返します
+ f(fold(0, -1))         は false、
+ f(fold(0, size() + 1)) は true と扱います
+ 時間計算量 O(logN)
+
+template<class F>
+-update (version_type version, size_type index, F f)->version_type
+ 版 version の index で指定した要素を f を適用した値に変更した版を
+ 作成して返します
+ 版 version は変更されません
+ 節点の数が 2^32 - 1 を超えてはいけません
+ 時間計算量 O(logN)
+
+template<class ForwardIterator>
+-compact (ForwardIterator first, ForwardIterator last)
+ [first, last) の版のみを残し、他の版が使用する節点をまとめて解放します
+ [first, last) の各要素は新しい版の値に書き換えられます
+ 残す版どうしで共有されていた節点は共有されたままです
+ 時間計算量 O(M)
+
+
+※N:全体の要素数
+※Q:update の呼び出し回数
+※M:compact 前の節点の数
+※value_structure の各関数の時間計算量を O(1) と仮定
+
+*/
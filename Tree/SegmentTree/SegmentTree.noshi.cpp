@@ -1,6 +1,9 @@
 #include <cassert>
 #include <iterator>
+#include <thread>
+#include <tuple>
 #include <utility>
+#include <vector>
 
 template <class Monoid, template <class> class Container> class segment_tree {
 public:
@@ -26,6 +29,38 @@ protected:
     tree[index] =
         value_structure::operation(tree[index << 1], tree[index << 1 | 1]);
   }
+  void construct(const size_type threads) {
+    const size_type cap = base_size();
+    size_type roots = 1;
+    while (roots < threads && roots < cap)
+      roots <<= 1;
+    if (roots == 1) {
+      roots = cap;
+    } else {
+      ::std::vector<::std::thread> workers;
+      for (size_type t = 0; t != threads; ++t) {
+        const size_type lo = roots + roots * t / threads,
+                        hi = roots + roots * (t + 1) / threads;
+        if (lo == hi)
+          continue;
+        workers.emplace_back([this, cap, lo, hi] {
+          size_type l = lo, r = hi;
+          while (l < cap)
+            l <<= 1, r <<= 1;
+          while (l != lo) {
+            l >>= 1;
+            r >>= 1;
+            for (size_type i = r; i-- != l;)
+              recalc(i);
+          }
+        });
+      }
+      for (auto &w : workers)
+        w.join();
+    }
+    for (size_type i = roots - 1; i; --i)
+      recalc(i);
+  }
 
 public:
   segment_tree() : size_(0), tree() {}
@@ -33,14 +68,16 @@ public:
       : size_(size), tree(getsize(size) << 1, value_structure::identity()) {}
   template <class InputIterator>
   segment_tree(InputIterator first, InputIterator last)
+      : segment_tree(first, last, 1) {}
+  template <class InputIterator>
+  segment_tree(InputIterator first, InputIterator last, const size_type threads)
       : size_(::std::distance(first, last)), tree() {
     const size_type cap = getsize(size_);
     tree.reserve(cap << 1);
     tree.resize(cap, value_structure::identity());
     tree.insert(tree.end(), first, last);
     tree.resize(cap << 1, value_structure::identity());
-    for (size_type i = cap - 1; i; --i)
-      recalc(i);
+    construct(threads);
   }
 
   bool empty() const { return !size_; }
@@ -77,6 +114,47 @@ public:
         acc = value_structure::operation(::std::move(acc), tree[i++]);
     return i - base_size() + 1;
   }
+  template <class F> size_type max_right(size_type first, const F &f) const {
+    assert(first <= size());
+    assert(f(value_structure::identity()));
+    if (first == size())
+      return size();
+    first += base_size();
+    value_type acc = value_structure::identity();
+    do {
+      while (!(first & 1))
+        first >>= 1;
+      if (!f(value_structure::operation(acc, tree[first]))) {
+        while (first < base_size())
+          if (f(value_structure::operation(acc, tree[first <<= 1])))
+            acc = value_structure::operation(::std::move(acc), tree[first++]);
+        return first - base_size();
+      }
+      acc = value_structure::operation(::std::move(acc), tree[first++]);
+    } while (first & (first - 1));
+    return size();
+  }
+  template <class F> size_type min_left(size_type last, const F &f) const {
+    assert(last <= size());
+    assert(f(value_structure::identity()));
+    if (last == 0)
+      return 0;
+    last += base_size();
+    value_type acc = value_structure::identity();
+    do {
+      --last;
+      while (last > 1 && (last & 1))
+        last >>= 1;
+      if (!f(value_structure::operation(tree[last], acc))) {
+        while (last < base_size())
+          if (f(value_structure::operation(tree[last = last << 1 | 1], acc)))
+            acc = value_structure::operation(tree[last--], ::std::move(acc));
+        return last + 1 - base_size();
+      }
+      acc = value_structure::operation(tree[last], ::std::move(acc));
+    } while (last & (last - 1));
+    return 0;
+  }
 
   template <class F> void update(size_type index, const F &f) {
     assert(index < size());
@@ -85,6 +163,34 @@ public:
     while (index >>= 1)
       recalc(index);
   }
+  template <class InputIterator>
+  void update_batch(InputIterator first, InputIterator last) {
+    size_type height = 0;
+    while (static_cast<size_type>(1) << height < base_size())
+      ++height;
+    ::std::vector<size_type> dirty;
+    bool rebuild = false;
+    for (; first != last; ++first) {
+      size_type index = ::std::get<0>(*first);
+      assert(index < size());
+      index += base_size();
+      tree[index] = ::std::get<1>(*first)(::std::move(tree[index]));
+      if (!rebuild) {
+        dirty.push_back(index);
+        if (dirty.size() * height * 2 >= base_size()) {
+          rebuild = true;
+          dirty.clear();
+        }
+      }
+    }
+    if (rebuild) {
+      construct(1);
+    } else {
+      for (size_type index : dirty)
+        while (index >>= 1)
+          recalc(index);
+    }
+  }
 };
 
 /*
@@ -150,6 +256,13 @@ template<class InputIterator>
  [first, last) の要素から segment_tree を構築します
  時間計算量 O(N)
 
+template<class InputIterator>
+-(constructor) (InputIterator first, InputIterator last, size_type threads)
+ [first, last) の要素から segment_tree を構築します
+ 内部節点の計算を threads 個のスレッドで部分木ごとに分担し、
+ 根に近い段のみを逐次に計算します
+ 時間計算量 O(N/P + P)
+
 -empty ()->bool
  size()==0 と同値です
  時間計算量 O(1)
@@ -174,13 +287,39 @@ template<class F>
  f(fold(0, size() + 1)) は true と扱います
  時間計算量 O(logN)
 
+template<class F>
+-max_right (size_type first, F f)->size_type
+ f(fold(first, i)) が true を返すような最大の i を返します
+ f(単位元) は true である必要があり、
+ f(fold(first, i)) が false ならば f(fold(first, i + 1)) も false である
+ 必要があります
+ 時間計算量 O(logN)
+
+template<class F>
+-min_left (size_type last, F f)->size_type
+ f(fold(i, last)) が true を返すような最小の i を返します
+ f(単位元) は true である必要があり、
+ f(fold(i, last)) が false ならば f(fold(i - 1, last)) も false である
+ 必要があります
+ 時間計算量 O(logN)
+
 template<class F>
 -update (size_type index, F f)
  指定した要素を f を適用した値に変更します
  時間計算量 O(logN)
 
+template<class InputIterator>
+-update_batch (InputIterator first, InputIterator last)
+ [first, last) の各要素 (index, f) について、先頭から順に
+ index で指定した要素を f を適用した値に変更します
+ 変更の数が N/(2logN) 以上のとき、祖先を個別に再計算せず
+ 全ての内部節点を 1 度だけ再計算します
+ 時間計算量 O(min(KlogN, K + N))
+
 
 ※N:全体の要素数
+※K:変更の数
+※P:スレッドの数
 ※value_structure の各関数の時間計算量を O(1) と仮定
 
 */
@@ -0,0 +1,218 @@
+#include <cassert>
+#include <iterator>
+#include <utility>
+
+template <class CommutativeMonoid, template <class> class Container>
+class segment_tree_2d {
+public:
+  using value_structure = CommutativeMonoid;
+  using value_type = typename value_structure::value_type;
+  using container_type = Container<value_type>;
+  using const_reference = typename container_type::const_reference;
+  using size_type = typename container_type::size_type;
+
+private:
+  static size_type getsize(const size_type size) {
+    size_type ret = 1;
+    while (ret < size)
+      ret <<= 1;
+    return ret;
+  }
+
+  size_type rows_, columns_, height, width;
+  container_type tree;
+
+  size_type node(const size_type row, const size_type column) const {
+    return row * (width << 1) + column;
+  }
+  void recalc_column(const size_type row, const size_type column) {
+    tree[node(row, column)] =
+        value_structure::operation(tree[node(row, column << 1)],
+                                   tree[node(row, column << 1 | 1)]);
+  }
+  void recalc_row(const size_type row, const size_type column) {
+    tree[node(row, column)] =
+        value_structure::operation(tree[node(row << 1, column)],
+                                   tree[node(row << 1 | 1, column)]);
+  }
+  value_type fold_row(const size_type row, size_type first,
+                      size_type last) const {
+    value_type ret = value_structure::identity();
+    for (first += width, last += width; first < last;
+         first >>= 1, last >>= 1) {
+      if (first & 1)
+        ret = value_structure::operation(::std::move(ret),
+                                         tree[node(row, first++)]);
+      if (last & 1)
+        ret = value_structure::operation(::std::move(ret),
+                                         tree[node(row, --last)]);
+    }
+    return ret;
+  }
+
+public:
+  segment_tree_2d() : rows_(0), columns_(0), height(1), width(1), tree() {}
+  segment_tree_2d(const size_type rows, const size_type columns)
+      : rows_(rows), columns_(columns), height(getsize(rows)),
+        width(getsize(columns)),
+        tree((height * width) << 2, value_structure::identity()) {}
+  template <class InputIterator>
+  segment_tree_2d(InputIterator first, InputIterator last,
+                  const size_type columns)
+      : rows_(columns ? ::std::distance(first, last) / columns : 0),
+        columns_(columns), height(getsize(rows_)), width(getsize(columns)),
+        tree((height * width) << 2, value_structure::identity()) {
+    assert(columns ? ::std::distance(first, last) % columns == 0
+                   : first == last);
+    for (size_type i = 0; i != rows_; ++i)
+      for (size_type j = 0; j != columns_; ++j)
+        tree[node(height + i, width + j)] = *first++;
+    for (size_type i = height; i != height << 1; ++i)
+      for (size_type j = width - 1; j; --j)
+        recalc_column(i, j);
+    for (size_type i = height - 1; i; --i)
+      for (size_type j = 1; j != width << 1; ++j)
+        recalc_row(i, j);
+  }
+
+  bool empty() const { return !rows_ || !columns_; }
+  size_type rows() const { return rows_; }
+  size_type columns() const { return columns_; }
+
+  const_reference get(const size_type row, const size_type column) const {
+    assert(row < rows());
+    assert(column < columns());
+    return tree[node(height + row, width + column)];
+  }
+  value_type fold(size_type row_first, size_type row_last,
+                  const size_type column_first,
+                  const size_type column_last) const {
+    assert(row_first <= row_last);
+    assert(row_last <= rows());
+    assert(column_first <= column_last);
+    assert(column_last <= columns());
+    value_type ret = value_structure::identity();
+    for (row_first += height, row_last += height; row_first < row_last;
+         row_first >>= 1, row_last >>= 1) {
+      if (row_first & 1)
+        ret = value_structure::operation(
+            ::std::move(ret), fold_row(row_first++, column_first, column_last));
+      if (row_last & 1)
+        ret = value_structure::operation(
+            ::std::move(ret), fold_row(--row_last, column_first, column_last));
+    }
+    return ret;
+  }
+
+  template <class F>
+  void update(const size_type row, const size_type column, const F &f) {
+    assert(row < rows());
+    assert(column < columns());
+    const size_type i = height + row, j = width + column;
+    tree[node(i, j)] = f(::std::move(tree[node(i, j)]));
+    for (size_type k = j >> 1; k; k >>= 1)
+      recalc_column(i, k);
+    for (size_type l = i >> 1; l; l >>= 1)
+      for (size_type k = j; k; k >>= 1)
+        recalc_row(l, k);
+  }
+};
+
+/*
+
+template<class CommutativeMonoid, template <class> class Container>
+class segment_tree_2d;
+
+segment_tree_2d は可換モノイドの長方形領域の和を高速に計算するデータ構造です
+行方向の segment_tree の各節点が列方向の segment_tree を持ち、
+全ての節点を 1 つの配列に行優先で確保します
+空間計算量 O(HW)
+
+
+テンプレートパラメータ
+-class CommutativeMonoid
+ -結合律
+  ∀a, ∀b, ∀c, a·(b·c) = (a·b)·c
+ -交換律
+  ∀a, ∀b, a·b = b·a
+ -単位元の存在
+  ∃e, ∀a, e·a = a·e = a
+ 以上の条件を満たす代数的構造 (可換モノイド)
+
+ 以下のメンバを要求します
+ -value_type
+  台集合の型
+ -static operation (value_type, value_type)->value_type
+  2引数を取り、演算した結果を返す静的関数
+ -static identity ()->value_type
+  単位元を返す静的関数
+
+-template <class> class Container
+ テンプレート引数を一つ取り、それを要素とするコンテナ型
+ 内部実装で使用します
+
+
+メンバ型
+-value_structure
+ 構造の型 (CommutativeMonoid)
+
+-value_type
+ 要素となる台集合の型 (value_structure::value_type)
+
+-container_type
+ 内部で使用するコンテナの型 (Container<value_type>)
+
+-const_reference
+ 要素へのconst参照型 (container_type::const_reference)
+
+-size_type
+ 符号なし整数型 (container_type::size_type)
+
+
+メンバ関数
+-(constructor) (size_type rows, size_type columns)
+ rows 行 columns 列の segment_tree_2d を構築します
+ 各要素は単位元で初期化されます
+ 時間計算量 O(HW)
+
+template<class InputIterator>
+-(constructor) (InputIterator first, InputIterator last, size_type columns)
+ [first, last) の要素を行優先で並べた columns 列の segment_tree_2d を
+ 構築します
+ 要素数は columns の倍数である必要があります
+ columns が 0 のとき、[first, last) は空である必要があります
+ 時間計算量 O(HW)
+
+-empty ()->bool
+ rows()==0 || columns()==0 と同値です
+ 時間計算量 O(1)
+
+-rows ()->size_type
+ 行数を返します
+ 時間計算量 O(1)
+
+-columns ()->size_type
+ 列数を返します
+ 時間計算量 O(1)
+
+-get (size_type row, size_type column)->const_reference
+ 指定した要素にアクセスします
+ 時間計算量 O(1)
+
+-fold (size_type row_first, size_type row_last,
+       size_type column_first, size_type column_last)->value_type
+ [row_first, row_last) 行 [column_first, column_last) 列の長方形領域の和を
+ 返します
+ 時間計算量 O(logHlogW)
+
+template<class F>
+-update (size_type row, size_type column, F f)
+ 指定した要素を f を適用した値に変更します
+ 時間計算量 O(logHlogW)
+
+
+※H:行数
+※W:列数
+※value_structure の各関数の時間計算量を O(1) と仮定
+
+*/
@@ -0,0 +1,291 @@
+#include <cassert>
+#include <iterator>
+#include <utility>
+
+template <class ValueMonoid, class OperatorMonoid, class Modifier,
+          template <class> class Container>
+class segment_tree_beats {
+public:
+  using value_structure = ValueMonoid;
+  using value_type = typename value_structure::value_type;
+  using const_reference = const value_type &;
+  using operator_structure = OperatorMonoid;
+  using operator_type = typename operator_structure::value_type;
+  using modifier = Modifier;
+  using container_type = Container<::std::pair<value_type, operator_type>>;
+  using size_type = typename container_type::size_type;
+
+private:
+  size_type size_, height;
+  container_type tree;
+  static size_type getheight(const size_type size) noexcept {
+    size_type ret = 0;
+    while (static_cast<size_type>(1) << ret < size)
+      ++ret;
+    return ret;
+  }
+  static value_type reflect(typename container_type::const_reference element) {
+    return modifier::operation(element.first, element.second);
+  }
+  void recalc(const size_type index) {
+    tree[index].first = value_structure::operation(
+        reflect(tree[index << 1]), reflect(tree[index << 1 | 1]));
+  }
+  static void assign(operator_type &element, const operator_type &data) {
+    element = operator_structure::operation(element, data);
+  }
+  void push(const size_type index) {
+    assign(tree[index << 1].second, tree[index].second);
+    assign(tree[index << 1 | 1].second, tree[index].second);
+    tree[index].second = operator_structure::identity();
+  }
+  void propagate(const size_type index) {
+    for (size_type i = height; i; --i)
+      push(index >> i);
+  }
+  void thrust(const size_type index) {
+    tree[index].first = reflect(tree[index]);
+    push(index);
+  }
+  void evaluate(const size_type index) {
+    for (size_type i = height; i; --i)
+      thrust(index >> i);
+  }
+  void build(size_type index) {
+    while (index >>= 1)
+      recalc(index);
+  }
+  void apply(const size_type index, const operator_type &data) {
+    if (index >= base_size() ||
+        modifier::applicable(reflect(tree[index]), data)) {
+      assign(tree[index].second, data);
+    } else {
+      thrust(index);
+      apply(index << 1, data);
+      apply(index << 1 | 1, data);
+      recalc(index);
+    }
+  }
+  size_type base_size() const { return static_cast<size_type>(1) << height; }
+
+public:
+  segment_tree_beats() : size_(0), height(0), tree() {}
+  explicit segment_tree_beats(const size_type size)
+      : size_(size), height(getheight(size_)),
+        tree(static_cast<size_type>(1) << (height + 1),
+             {value_structure::identity(), operator_structure::identity()}) {}
+  template <class InputIterator>
+  segment_tree_beats(InputIterator first, InputIterator last)
+      : size_(::std::distance(first, last)), height(getheight(size_)), tree() {
+    const size_type cap = static_cast<size_type>(1) << height;
+    tree.reserve(cap << 1);
+    tree.resize(cap,
+                {value_structure::identity(), operator_structure::identity()});
+    for (; first != last; ++first)
+      tree.emplace_back(*first, operator_structure::identity());
+    tree.resize(cap << 1,
+                {value_structure::identity(), operator_structure::identity()});
+    for (size_type i = cap - 1; i; --i)
+      recalc(i);
+  }
+
+  bool empty() const { return !size_; }
+  size_type size() const { return size_; }
+
+  const_reference operator[](size_type index) {
+    assert(index < size());
+    index += base_size();
+    evaluate(index);
+    tree[index].first = reflect(tree[index]);
+    tree[index].second = operator_structure::identity();
+    return tree[index].first;
+  }
+  value_type fold(size_type first, size_type last) {
+    assert(first <= last);
+    assert(first <= size());
+    assert(last <= size());
+    if (first == last)
+      return value_structure::identity();
+    first += base_size();
+    last += base_size();
+    evaluate(first);
+    evaluate(last - 1);
+    value_type ret_l = value_structure::identity(),
+               ret_r = value_structure::identity();
+    for (; first < last; first >>= 1, last >>= 1) {
+      if (first & 1)
+        ret_l = value_structure::operation(ret_l, reflect(tree[first++]));
+      if (last & 1)
+        ret_r = value_structure::operation(reflect(tree[last - 1]), ret_r);
+    }
+    return value_structure::operation(ret_l, ret_r);
+  }
+
+  template <class F> void update(size_type index, const F &f) {
+    assert(index < size());
+    index += base_size();
+    propagate(index);
+    tree[index].first = f(reflect(tree[index]));
+    tree[index].second = operator_structure::identity();
+    build(index);
+  }
+  void update(size_type first, size_type last, const operator_type &data) {
+    assert(first <= last);
+    assert(first <= size());
+    assert(last <= size());
+    if (first == last)
+      return;
+    first += base_size();
+    last += base_size();
+    evaluate(first);
+    evaluate(last - 1);
+    for (size_type left = first, right = last; left < right;
+         left >>= 1, right >>= 1) {
+      if (left & 1)
+        apply(left++, data);
+      if (right & 1)
+        apply(right - 1, data);
+    }
+    build(first);
+    build(last - 1);
+  }
+};
+
+/*
+
+template<class ValueMonoid, class OperatorMonoid, class Modifier,
+         template <class> class Container>
+class segment_tree_beats;
+
+segment_tree_beats は lazy_segment_tree を、
+節点によっては作用を遅延できない場合に拡張したものです
+作用を遅延できない節点では子に再帰します
+range chmin / chmax / add と区間和のような作用を扱えます
+空間計算量 O(N)
+
+
+テンプレートパラメータ
+-class ValueMonoid
+ -結合律
+  ∀a, ∀b, ∀c, a·(b·c) = (a·b)·c
+ -単位元の存在
+  ∃e, ∀a, e·a = a·e = a
+ 以上の条件を満たす代数的構造 (モノイド)
+
+ 以下のメンバを要求します
+ -value_type
+  台集合の型
+ -static operation (value_type, value_type)->value_type
+  2引数を取り、演算した結果を返す静的関数
+ -static identity ()->value_type
+  単位元を返す静的関数
+
+-class OperatorMonoid
+ -結合律
+  ∀a, ∀b, ∀c, a·(b·c) = (a·b)·c
+ -単位元の存在
+  ∃e, ∀a, e·a = a·e = a
+ 以上の条件を満たす代数的構造 (モノイド)
+
+ 以下のメンバを要求します
+ -value_type
+  台集合の型
+ -static operation (value_type, value_type)->value_type
+  2引数を取り、演算した結果を返す静的関数
+ -static identity ()->value_type
+  単位元を返す静的関数
+
+-class Modifier
+ (ValueMonoid の台集合を V、OperatorMonoid の台集合を O、Modifier を m、
+  m(a, b) が計算可能であることを p(a, b) と表記)
+ -閉性
+  ∀a∈V, ∀b∈O, p(a, b) ⇒ m(a, b)∈V
+ -結合律
+  ∀a∈V, ∀b∈O, ∀c∈O, p(a, b) ∧ p(m(a, b), c) ⇒
+  p(a, b·c) ∧ m(a, b·c) = m(m(a, b), c)
+ -分配法則
+  ∀a∈V, ∀b∈V, ∀c∈O, p(a·b, c) ⇒
+  p(a, c) ∧ p(b, c) ∧ m(a, c)·m(b, c) = m(a·b, c)
+ 以上の条件を満たすように ValueMonoid に OperatorMonoid を作用させるクラス
+ 1 要素のみからなる区間の値に対しては、p は常に真である必要があります
+
+ 以下のメンバを要求します
+ -static operation (ValueMonoid::value_type, OperatorMonoid::value_type)
+                    ->ValueMonoid::value_type
+  2引数を取り、作用させた結果を返す静的関数
+ -static applicable (ValueMonoid::value_type, OperatorMonoid::value_type)
+                    ->bool
+  2引数を取り、作用させた結果が計算可能であるか (p) を返す静的関数
+  false を返した場合、子に再帰して作用させます
+
+-template <class> class Container
+ 型引数を1つ取り、それを要素とするコンテナ型
+ 内部実装で使用します
+
+
+メンバ型
+-value_structure
+ 要素の構造の型 (ValueMonoid)
+
+-value_type
+ 要素の型 (value_structure::value_type)
+
+-const_reference
+ 要素(value_type)へのconst参照型 (const value_type &)
+
+-operator_structure
+ 演算要素の構造の型 (OperatorMonoid)
+
+-operator_type
+ 演算要素の型 (operator_structure::value_type)
+
+-container_type
+ 内部実装のコンテナ型 (Container<::std::pair<value_type, operator_type>>)
+
+-size_type
+ 符号なし整数型 (container_type::size_type)
+
+
+メンバ関数
+-(constructor) (size_type size)
+ 要素数 size の segment_tree_beats を構築します
+ 各要素は単位元で初期化されます
+ 時間計算量 O(N)
+
+template<class InputIterator>
+-(constructor) (InputIterator first, InputIterator last)
+ [first, last) の要素から segment_tree_beats を構築します
+ 時間計算量 O(N)
+
+-empty ()->bool
+ size()==0 と同値です
+ 時間計算量 O(1)
+
+-size ()->size_type
+ 要素数を返します
+ 時間計算量 O(1)
+
+-operator[] (size_type index)->const_reference
+ index で指定した要素にアクセスします
+ 時間計算量 O(logN)
+
+-fold (size_type first, size_type last)->value_type
+ [first, last) の和を返します
+ first == last のとき 単位元を返します
+ 時間計算量 O(logN)
+
+template<class F>
+-update (size_type index, F f)
+ index で指定した要素を f を適用した値で更新します
+ 時間計算量 O(logN)
+
+-update (size_type first, size_type last const operator_type &data)
+ [first, last) に data を作用させます
+ 時間計算量 作用に依存します
+ range chmin / chmax と区間和の場合 償却 O(log^2N)
+
+
+※N:全体の要素数
+※各種関数の時間計算量を O(1) と仮定
+
+*/
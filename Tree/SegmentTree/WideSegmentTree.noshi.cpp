@@ -0,0 +1,295 @@
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+template <class Monoid, template <class> class Container,
+          ::std::size_t Branch = 8>
+class wide_segment_tree {
+  static_assert(Branch >= 2, "Branch must be at least 2");
+
+public:
+  using value_structure = Monoid;
+  using value_type = typename value_structure::value_type;
+  using container_type = Container<value_type>;
+  using const_reference = typename container_type::const_reference;
+  using size_type = typename container_type::size_type;
+  static constexpr size_type branch = Branch;
+
+protected:
+  template <class T, class = bool>
+  class simd_reducible : public ::std::false_type {};
+  template <class T>
+  class simd_reducible<T, decltype(static_cast<bool>(T::is_simd_reducible))>
+      : public ::std::integral_constant<bool, T::is_simd_reducible> {};
+  static constexpr bool vectorize = simd_reducible<value_structure>::value;
+  static constexpr ::std::size_t linesize = 64;
+  static constexpr size_type padding =
+      linesize % sizeof(value_type) ? 0 : linesize / sizeof(value_type) - 1;
+
+  static size_type getsize(const size_type size) {
+    size_type ret = 1;
+    while (ret < size)
+      ret *= branch;
+    return ret;
+  }
+  static size_type parent(const size_type index) {
+    return index / branch + branch - 2;
+  }
+  static size_type child(const size_type index) {
+    return (index - branch + 2) * branch;
+  }
+
+  size_type size_, leaf, origin;
+  container_type tree;
+
+  void allocate(const size_type len) {
+    tree.assign(len + padding, value_structure::identity());
+    const ::std::uintptr_t address =
+        reinterpret_cast<::std::uintptr_t>(&tree[0]);
+    origin = padding ? (linesize - address % linesize) % linesize /
+                           sizeof(value_type)
+                     : 0;
+  }
+
+  value_type reduce(const size_type index, const size_type len) const {
+    value_type acc = value_structure::identity();
+    for (size_type i = 0; i != len; ++i)
+      acc = value_structure::operation(::std::move(acc),
+                                       tree[origin + index + i]);
+    return acc;
+  }
+  value_type reduce_block(const size_type index, ::std::false_type) const {
+    return reduce(index, branch);
+  }
+  value_type reduce_block(const size_type index, ::std::true_type) const {
+    constexpr size_type half = (Branch + 1) / 2;
+    value_type lane[half];
+    for (size_type i = 0; i != branch - half; ++i)
+      lane[i] = value_structure::operation(tree[origin + index + i],
+                                           tree[origin + index + i + half]);
+    if (branch % 2)
+      lane[half - 1] = tree[origin + index + half - 1];
+    for (size_type w = half, h; w != 1; w = h) {
+      h = (w + 1) / 2;
+      for (size_type i = 0; i != w - h; ++i)
+        lane[i] = value_structure::operation(lane[i], lane[i + h]);
+    }
+    return lane[0];
+  }
+  void recalc(const size_type index) {
+    tree[origin + index] = reduce(child(index), branch);
+  }
+  void build() {
+    for (size_type i = leaf; i-- != branch - 1;)
+      tree[origin + i] = reduce_block(
+          child(i), ::std::integral_constant<bool, vectorize>());
+  }
+
+public:
+  wide_segment_tree() : size_(0), leaf(branch - 1), origin(0), tree() {
+    allocate(branch);
+  }
+  explicit wide_segment_tree(const size_type size)
+      : size_(size), leaf(), origin(0), tree() {
+    const size_type cap = getsize(size_);
+    leaf = branch - 1 + (cap - 1) / (branch - 1);
+    allocate(leaf + cap);
+  }
+  template <class InputIterator>
+  wide_segment_tree(InputIterator first, InputIterator last)
+      : size_(::std::distance(first, last)), leaf(), origin(0), tree() {
+    const size_type cap = getsize(size_);
+    leaf = branch - 1 + (cap - 1) / (branch - 1);
+    allocate(leaf + cap);
+    for (size_type i = origin + leaf; first != last; ++first, ++i)
+      tree[i] = *first;
+    build();
+  }
+  wide_segment_tree(const wide_segment_tree &other)
+      : size_(other.size_), leaf(other.leaf), origin(0), tree() {
+    const size_type len = other.tree.size() - padding;
+    allocate(len);
+    for (size_type i = 0; i != len; ++i)
+      tree[origin + i] = other.tree[other.origin + i];
+  }
+  wide_segment_tree(wide_segment_tree &&) = default;
+  wide_segment_tree &operator=(const wide_segment_tree &other) {
+    return *this = wide_segment_tree(other);
+  }
+  wide_segment_tree &operator=(wide_segment_tree &&) = default;
+
+  bool empty() const { return !size_; }
+  size_type size() const { return size_; }
+
+  const_reference operator[](const size_type index) const {
+    assert(index < size());
+    return tree[origin + leaf + index];
+  }
+  value_type fold(size_type first, size_type last) const {
+    assert(first <= last);
+    assert(first <= size());
+    assert(last <= size());
+    value_type ret_l = value_structure::identity(),
+               ret_r = value_structure::identity();
+    for (size_type offset = leaf; first < last;
+         first /= branch, last /= branch, offset = parent(offset)) {
+      if (first < last && first % branch) {
+        const size_type len =
+            ::std::min<size_type>(last - first, branch - first % branch);
+        ret_l = value_structure::operation(::std::move(ret_l),
+                                           reduce(offset + first, len));
+        first += len;
+      }
+      if (first < last && last % branch) {
+        const size_type len = last % branch;
+        last -= len;
+        ret_r = value_structure::operation(reduce(offset + last, len),
+                                           ::std::move(ret_r));
+      }
+    }
+    return value_structure::operation(::std::move(ret_l), ::std::move(ret_r));
+  }
+  template <class F> size_type search(const F &f) const {
+    if (f(value_structure::identity()))
+      return 0;
+    if (!f(tree[origin + branch - 1]))
+      return size() + 1;
+    value_type acc = value_structure::identity();
+    size_type i = branch - 1;
+    while (i < leaf)
+      for (i = child(i);
+           !f(value_structure::operation(acc, tree[origin + i]));)
+        acc = value_structure::operation(::std::move(acc), tree[origin + i++]);
+    return i - leaf + 1;
+  }
+
+  template <class F> void update(size_type index, const F &f) {
+    assert(index < size());
+    index += leaf;
+    tree[origin + index] = f(::std::move(tree[origin + index]));
+    while (index != branch - 1)
+      recalc(index = parent(index));
+  }
+};
+
+/*
+
+template<class Monoid, template <class> class Container,
+         ::std::size_t Branch = 8>
+class wide_segment_tree;
+
+wide_segment_tree は segment_tree の各節点を Branch 分木にしたものです
+兄弟節点を連続したメモリに配置し、Container が連続したメモリを持つ場合は
+兄弟節点の組の先頭を 64 byte 境界に揃えます
+木全体がキャッシュに収まる大きさでは fold が segment_tree より速くなりますが、
+収まらない大きさでは segment_tree の方が速くなります
+空間計算量 O(N)
+
+
+テンプレートパラメータ
+-class Monoid
+ -結合律
+  ∀a, ∀b, ∀c, a·(b·c) = (a·b)·c
+ -単位元の存在
+  ∃e, ∀a, e·a = a·e = a
+ 以上の条件を満たす代数的構造 (モノイド)
+
+ 以下のメンバを要求します
+ -value_type
+  台集合の型
+ -static operation (value_type, value_type)->value_type
+  2引数を取り、演算した結果を返す静的関数
+ -static identity ()->value_type
+  単位元を返す静的関数
+
+ 以下のメンバは任意です
+ -static constexpr bool is_simd_reducible
+  true のとき、Monoid が交換律を満たすとみなし、
+  構築時に兄弟節点の和を並べ替えて計算することで自動ベクトル化を可能にします
+  この指定は構築にのみ影響し、fold と update は指定の有無に関わらず
+  同じく順に計算します
+  (直前に書き込んだ節点をベクトルで読み直すと遅くなるためです)
+  true のとき、value_type はデフォルト構築可能である必要があります
+
+-template <class> class Container
+ テンプレート引数を一つ取り、それを要素とするコンテナ型
+ 内部実装で使用します
+
+-::std::size_t Branch
+ 各節点の子の数 (2 以上)
+ Branch = 2 のとき segment_tree と同じ配置になります
+ 兄弟節点の大きさの合計がキャッシュラインに収まる値を推奨します
+
+
+メンバ型
+-value_structure
+ 構造の型 (Monoid)
+
+-value_type
+ 要素となる台集合の型 (value_structure::value_type)
+
+-container_type
+ 内部で使用するコンテナの型 (Container<value_type>)
+
+-const_reference
+ 要素へのconst参照型 (container_type::const_reference)
+
+-size_type
+ 符号なし整数型 (container_type::size_type)
+
+
+メンバ定数
+-branch
+ Branch
+
+
+メンバ関数
+-(constructor) (size_type size)
+ 要素数 size で wide_segment_tree を構築します
+ 各要素は単位元で初期化されます
+ 時間計算量 O(N)
+
+template<class InputIterator>
+-(constructor) (InputIterator first, InputIterator last)
+ [first, last) の要素から wide_segment_tree を構築します
+ 時間計算量 O(N)
+
+-empty ()->bool
+ size()==0 と同値です
+ 時間計算量 O(1)
+
+-size ()->size_type
+ 要素数を返します
+ 時間計算量 O(1)
+
+-operator[] (size_type index)->const_reference
+ 指定した要素にアクセスします
+ 時間計算量 O(1)
+
+-fold (size_type first, size_type last)->value_type
+ [first, last) の和を返します
+ 時間計算量 O(BlogN/logB)
+
+template<class F>
+-search (F f)->size_type
+ f(fold(0, i - 1)) が false を返し、
+ f(fold(0, i))     が true  を返すような i を返します
+ f(fold(0, -1))         は false、
+ f(fold(0, size() + 1)) は true と扱います
+ 時間計算量 O(BlogN/logB)
+
+template<class F>
+-update (size_type index, F f)
+ 指定した要素を f を適用した値に変更します
+ 時間計算量 O(BlogN/logB)
+
+
+※N:全体の要素数
+※B:Branch
+※value_structure の各関数の時間計算量を O(1) と仮定
+
+*/
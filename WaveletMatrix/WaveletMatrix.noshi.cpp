@@ -3,7 +3,9 @@
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <queue>
 #include <stdexcept>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -30,30 +32,139 @@ private:
     }
     using value_type = typename wavelet_matrix::value_type;
     using size_type = typename wavelet_matrix::size_type;
-    ::std::vector<::std::pair<bitfield, size_type>> dic;
+    static constexpr ::std::size_t blockwords = 8;
+    static constexpr ::std::size_t fieldsize = 9;
+    static constexpr ::std::size_t samplesize = 512;
+    static size_type select(bitfield c, size_type k) {
+      size_type ret = 0;
+      for (size_type w = wordsize / 2; w; w >>= 1) {
+        const size_type p = popcount(c & ((static_cast<bitfield>(1) << w) - 1));
+        if (p <= k)
+          k -= p, c >>= w, ret += w;
+      }
+      return ret;
+    }
+    static constexpr ::std::size_t linesize = 64;
+    static bitfield *align(::std::vector<bitfield> &buffer) {
+      const ::std::uintptr_t address =
+          reinterpret_cast<::std::uintptr_t>(buffer.data());
+      return buffer.data() + (linesize - address % linesize) % linesize /
+                                 sizeof(bitfield);
+    }
+    ::std::vector<bitfield> buffer;
+    bitfield *dic;
+    size_type blocks;
+    ::std::vector<size_type> sample1, sample0;
+    size_type ones(const size_type block) const {
+      return static_cast<size_type>(dic[block * blockwords]);
+    }
+    size_type ones(const size_type block, const size_type w) const {
+      return static_cast<size_type>(dic[block * blockwords + 1] >>
+                                    (w * fieldsize) & ((1 << fieldsize) - 1));
+    }
+    size_type zeros(const size_type block) const {
+      return block * blocksize - ones(block);
+    }
+    size_type zeros(const size_type block, const size_type w) const {
+      return w * wordsize - ones(block, w);
+    }
+    static size_type word(const size_type index) {
+      return index / blocksize * blockwords + index % blocksize / wordsize + 2;
+    }
 
   public:
+    static constexpr ::std::size_t blocksize = wordsize * (blockwords - 2);
     size_type cnt;
     value_type bit;
-    constexpr bitvector() : dic(), cnt(0), bit(0) {}
+    constexpr bitvector()
+        : buffer(), dic(nullptr), blocks(0), sample1(), sample0(), cnt(0),
+          bit(0) {}
     bitvector(const size_type size, const value_type b)
-        : dic(size / wordsize + 1, {0, 0}), cnt(0), bit(b) {}
-    void set(const size_type index) {
-      dic[index / wordsize].first |= static_cast<bitfield>(1)
-                                     << (index % wordsize);
+        : buffer((size / blocksize + 1) * blockwords +
+                     linesize / sizeof(bitfield) - 1,
+                 0),
+          dic(align(buffer)), blocks(size / blocksize + 1), sample1(),
+          sample0(), cnt(0), bit(b) {}
+    bitvector(const bitvector &other)
+        : buffer(other.buffer.size()), dic(align(buffer)),
+          blocks(other.blocks), sample1(other.sample1),
+          sample0(other.sample0), cnt(other.cnt), bit(other.bit) {
+      ::std::copy(other.dic, other.dic + blocks * blockwords, dic);
+    }
+    bitvector(bitvector &&) = default;
+    bitvector &operator=(const bitvector &other) {
+      return *this = bitvector(other);
+    }
+    bitvector &operator=(bitvector &&) = default;
+    void store(const size_type index, const bitfield bits) {
+      dic[word(index)] = bits;
     }
     void build() {
-      const size_type len = dic.size();
-      for (size_type i = 1; i < len; ++i)
-        dic[i].second = dic[i - 1].second + popcount(dic[i - 1].first);
+      bitfield sum = 0;
+      for (size_type i = 0; i != blocks * blockwords; i += blockwords) {
+        bitfield rel = 0, local = 0;
+        for (size_type j = 0; j != blockwords - 2; ++j) {
+          rel |= local << (j * fieldsize);
+          local += popcount(dic[i + 2 + j]);
+        }
+        dic[i] = sum;
+        dic[i + 1] = rel;
+        sum += local;
+      }
+      sample1.clear();
+      sample0.clear();
+      for (size_type b = 0; b != blocks; ++b) {
+        const size_type o = b + 1 != blocks ? ones(b + 1)
+                                            : static_cast<size_type>(sum),
+                        z = (b + 1) * blocksize - o;
+        while (sample1.size() * samplesize < o)
+          sample1.push_back(b);
+        while (sample0.size() * samplesize < z)
+          sample0.push_back(b);
+      }
     }
     size_type rank(const size_type last) const {
-      return dic[last / wordsize].second +
-             popcount(dic[last / wordsize].first &
-                      (static_cast<bitfield>(1) << (last % wordsize)) - 1);
+      const size_type head = last / blocksize * blockwords,
+                      w = last % blocksize / wordsize;
+      return static_cast<size_type>(dic[head]) +
+             static_cast<size_type>(dic[head + 1] >> (w * fieldsize) &
+                                    ((1 << fieldsize) - 1)) +
+             popcount(dic[head + 2 + w] &
+                      ((static_cast<bitfield>(1) << (last % wordsize)) - 1));
     }
     bool access(const size_type index) const {
-      return dic[index / wordsize].first >> (index % wordsize) & 1;
+      return dic[word(index)] >> (index % wordsize) & 1;
+    }
+    size_type select1(const size_type k) const {
+      const size_type i = k / samplesize;
+      size_type lo = sample1[i],
+                hi = i + 1 != sample1.size() ? sample1[i + 1] + 1 : blocks;
+      while (hi - lo > 1) {
+        const size_type mid = lo + (hi - lo) / 2;
+        (ones(mid) <= k ? lo : hi) = mid;
+      }
+      size_type w = 1;
+      while (w != blockwords - 2 && ones(lo, w) <= k - ones(lo))
+        ++w;
+      --w;
+      return lo * blocksize + w * wordsize +
+             select(dic[lo * blockwords + 2 + w], k - ones(lo) - ones(lo, w));
+    }
+    size_type select0(const size_type k) const {
+      const size_type i = k / samplesize;
+      size_type lo = sample0[i],
+                hi = i + 1 != sample0.size() ? sample0[i + 1] + 1 : blocks;
+      while (hi - lo > 1) {
+        const size_type mid = lo + (hi - lo) / 2;
+        (zeros(mid) <= k ? lo : hi) = mid;
+      }
+      size_type w = 1;
+      while (w != blockwords - 2 && zeros(lo, w) <= k - zeros(lo))
+        ++w;
+      --w;
+      return lo * blocksize + w * wordsize +
+             select(~dic[lo * blockwords + 2 + w],
+                    k - zeros(lo) - zeros(lo, w));
     }
   };
   static bool valid(const value_type value) {
@@ -82,30 +193,78 @@ private:
     return ret + last - first;
   }
 
+  struct node {
+    size_type first, last, depth;
+    value_type value;
+  };
+  struct frequent {
+    bool operator()(const node &x, const node &y) const {
+      return x.last - x.first != y.last - y.first
+                 ? x.last - x.first < y.last - y.first
+                 : y.value < x.value;
+    }
+  };
+
+  template <class F> static void parallel(const size_type threads, const F &f) {
+    ::std::vector<::std::thread> workers;
+    for (size_type t = 1; t < threads; ++t)
+      workers.emplace_back(f, t);
+    f(0);
+    for (auto &w : workers)
+      w.join();
+  }
+
 public:
   constexpr wavelet_matrix() : matrix(), size_(0) {}
   template <class InputIter>
-  wavelet_matrix(InputIter first, InputIter last) : matrix(), size_(0) {
+  wavelet_matrix(InputIter first, InputIter last)
+      : wavelet_matrix(first, last, 1) {}
+  template <class InputIter>
+  wavelet_matrix(InputIter first, InputIter last, const size_type threads)
+      : matrix(), size_(0) {
     ::std::vector<value_type> vec0(first, last);
-    const size_type len = vec0.size();
+    const size_type len = vec0.size(),
+                    blocks = len / bitvector::blocksize + 1,
+                    parts = ::std::max<size_type>(
+                        1, ::std::min<size_type>(threads, blocks));
     size_ = len;
-    ::std::vector<value_type> vec_l(len), vec_r(len);
-    size_type l, r;
+    ::std::vector<value_type> vec1(len);
+    ::std::vector<size_type> bound(parts + 1), ones(parts + 1, 0);
+    for (size_type t = 0; t != parts; ++t)
+      bound[t] = ::std::min(len, blocks * t / parts * bitvector::blocksize);
+    bound[parts] = len;
     value_type temp = static_cast<value_type>(1) << (Bitlength - 1);
     for (auto &v : matrix) {
       v = bitvector(len, temp);
       temp >>= 1;
-      l = 0;
-      r = 0;
-      for (size_type j = 0; j < len; ++j)
-        if (vec0[j] & v.bit)
-          vec_r[r++] = vec0[j], v.set(j);
-        else
-          vec_l[l++] = vec0[j];
-      v.cnt = l;
+      parallel(parts, [&](const size_type t) {
+        size_type cnt = 0;
+        for (size_type j = bound[t]; j < bound[t + 1]; j += 64) {
+          const size_type e = ::std::min(j + 64, bound[t + 1]);
+          ::std::uint_least64_t bits = 0;
+          for (size_type k = j; k != e; ++k) {
+            const bool b = vec0[k] & v.bit;
+            bits |= static_cast<::std::uint_least64_t>(b) << (k - j);
+            cnt += b;
+          }
+          v.store(j, bits);
+        }
+        ones[t + 1] = cnt;
+      });
+      for (size_type t = 0; t != parts; ++t)
+        ones[t + 1] += ones[t];
+      v.cnt = len - ones[parts];
+      parallel(parts, [&](const size_type t) {
+        size_type l = bound[t] - ones[t], r = v.cnt + ones[t];
+        for (size_type k = bound[t]; k != bound[t + 1]; ++k) {
+          const bool b = vec0[k] & v.bit;
+          vec1[b ? r : l] = vec0[k];
+          r += b;
+          l += !b;
+        }
+      });
       v.build();
-      ::std::swap(vec0, vec_l);
-      ::std::copy(vec_r.cbegin(), vec_r.cbegin() + r, vec0.begin() + l);
+      ::std::swap(vec0, vec1);
     }
   }
 
@@ -142,6 +301,75 @@ public:
         first -= v.rank(first), last -= v.rank(last);
     return last - first;
   }
+  size_type select(const value_type value, const size_type k) const {
+    assert(valid(value));
+    assert(value != none);
+    size_type first = 0, last = size();
+    for (const auto &v : matrix)
+      if (value & v.bit)
+        first = v.rank(first) + v.cnt, last = v.rank(last) + v.cnt;
+      else
+        first -= v.rank(first), last -= v.rank(last);
+    if (last - first <= k)
+      return size();
+    size_type ret = first + k;
+    for (auto v = matrix.crbegin(); v != matrix.crend(); ++v)
+      ret = value & v->bit ? v->select1(ret - v->cnt) : v->select0(ret);
+    return ret;
+  }
+  ::std::vector<::std::pair<value_type, size_type>>
+  topk_freq(const size_type first, const size_type last, size_type k) const {
+    assert(first <= size());
+    assert(last <= size());
+    assert(first <= last);
+    ::std::vector<::std::pair<value_type, size_type>> ret;
+    ::std::priority_queue<node, ::std::vector<node>, frequent> que;
+    if (first != last)
+      que.push({first, last, 0, 0});
+    while (k && !que.empty()) {
+      const node cur = que.top();
+      que.pop();
+      if (cur.depth == Bitlength) {
+        ret.emplace_back(cur.value, cur.last - cur.first);
+        --k;
+        continue;
+      }
+      const bitvector &v = matrix[cur.depth];
+      const size_type l = v.rank(cur.first), r = v.rank(cur.last);
+      if (cur.first - l != cur.last - r)
+        que.push({cur.first - l, cur.last - r, cur.depth + 1, cur.value});
+      if (l != r)
+        que.push({l + v.cnt, r + v.cnt, cur.depth + 1, cur.value | v.bit});
+    }
+    return ret;
+  }
+  ::std::vector<::std::pair<value_type, size_type>>
+  enumerate(const size_type first, const size_type last) const {
+    assert(first <= size());
+    assert(last <= size());
+    assert(first <= last);
+    ::std::vector<::std::pair<value_type, size_type>> ret;
+    ::std::vector<node> stack;
+    if (first != last)
+      stack.push_back({first, last, 0, 0});
+    while (!stack.empty()) {
+      const node cur = stack.back();
+      stack.pop_back();
+      if (cur.depth == Bitlength) {
+        ret.emplace_back(cur.value, cur.last - cur.first);
+        continue;
+      }
+      const bitvector &v = matrix[cur.depth];
+      const size_type l = v.rank(cur.first), r = v.rank(cur.last);
+      if (l != r)
+        stack.push_back(
+            {l + v.cnt, r + v.cnt, cur.depth + 1, cur.value | v.bit});
+      if (cur.first - l != cur.last - r)
+        stack.push_back(
+            {cur.first - l, cur.last - r, cur.depth + 1, cur.value});
+    }
+    return ret;
+  }
   value_type quantile(size_type first, size_type last, size_type k = 0,
                       const value_type upper = none) const {
     assert(first <= size());
@@ -229,6 +457,13 @@ template <class InpuIter>
  負数が含まれる場合、要素の大小関係を扱う関数が正常に機能しません
  時間計算量 O(N*Bitlength)
 
+template <class InpuIter>
+-(constructor) (InputIter first, InpuIter last, size_type threads)
+ [first, last) の要素から wavelet_matrix を構築します
+ 各段で列を threads 個に分割し、bit 列の書き込みと安定な分割を
+ スレッドごとに行います
+ 時間計算量 O(N*Bitlength/P + P*Bitlength)
+
 -size ()->size_type
  要素数を返します
  時間計算量 O(1)
@@ -250,6 +485,12 @@ template <class InpuIter>
  [first, last) に存在する value の数を返します
  時間計算量 O(Bitlength)
 
+-select (value_type value, size_type k)->size_type
+ k 番目 (0-indexed) に現れる value の位置を返します
+ value が k + 1 個以上存在しない時、size() を返します
+ 時間計算量 O(BitlengthlogN)
+ 位置の偏りが小さい場合はほぼ O(Bitlength) で動作します
+
 -quantile (size_type first, size_type last, size_type k = 0,
            value_type upper = none)->value_type
  [first, last) で upper 未満の値のうち k 番目 (0-indexed) に大きい値を返します
@@ -272,7 +513,29 @@ template <class InpuIter>
  下限、上限が両方存在するとき、lower <= upper が要求されます
  時間計算量 O(Bitlength)
 
+-topk_freq (size_type first, size_type last, size_type k)
+ ->::std::vector<::std::pair<value_type, size_type>>
+ [first, last) に存在する値を出現回数の多い順に k 個まで、
+ (値, 出現回数) の組として返します
+ 出現回数が等しい値は小さい順に並びます
+ 出現回数の多い部分木から優先度付きキューで辿ります
+ 時間計算量 O(M*Bitlength*log(M*Bitlength))
+
+-enumerate (size_type first, size_type last)
+ ->::std::vector<::std::pair<value_type, size_type>>
+ [first, last) に存在する相異なる値を小さい順に、
+ (値, 出現回数) の組として返します
+ 時間計算量 O(D*Bitlength)
+
 ※N:全体の要素数
+※P:スレッドの数
+※D:[first, last) に存在する相異なる値の数
+※M:出現回数が k 番目に多い値の出現回数を F として、min(D, (last - first) / F)
+※各段の bit 列は 64 bit の累積個数、組内の 64 bit ごとの累積個数、384 bit の値を
+  64 バイト境界に揃えた 64 バイトの組にして保持し、rank は 1 つのキャッシュラインのみを
+  参照します
+  (bit 列の約 1.33 倍のメモリを使用します)
+※select のため、各段で 512 個ごとの 0 と 1 の位置を含む組の番号を保持します
 ※popcount() の時間計算量を O(1) と仮定
   デフォルトの実装は O(logloglogN) です
 
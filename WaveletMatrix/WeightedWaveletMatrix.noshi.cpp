@@ -0,0 +1,319 @@
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+template <class Integral, ::std::size_t Bitlength, Integral None, class Weight>
+class weighted_wavelet_matrix {
+public:
+  using value_type = Integral;
+  using weight_type = Weight;
+  using size_type = ::std::size_t;
+  static constexpr value_type none = None;
+
+private:
+  class bitvector {
+    using bitfield = ::std::uint_least64_t;
+    static constexpr ::std::size_t wordsize = 64;
+    static ::std::size_t popcount(bitfield c) {
+#ifdef __has_builtin
+      return __builtin_popcountll(c);
+#else
+      c = (c & 0x5555555555555555ULL) + (c >> 1 & 0x5555555555555555ULL);
+      c = (c & 0x3333333333333333ULL) + (c >> 2 & 0x3333333333333333ULL);
+      c = (c + (c >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+      return static_cast<::std::size_t>(c * 0x0101010101010101ULL >> 56 & 0x7f);
+#endif
+    }
+    using value_type = typename weighted_wavelet_matrix::value_type;
+    using size_type = typename weighted_wavelet_matrix::size_type;
+    static constexpr ::std::size_t blockwords = 8;
+    static constexpr ::std::size_t blocksize = wordsize * (blockwords - 2);
+    static constexpr ::std::size_t fieldsize = 9;
+    static constexpr ::std::size_t linesize = 64;
+    static bitfield *align(::std::vector<bitfield> &buffer) {
+      const ::std::uintptr_t address =
+          reinterpret_cast<::std::uintptr_t>(buffer.data());
+      return buffer.data() + (linesize - address % linesize) % linesize /
+                                 sizeof(bitfield);
+    }
+    ::std::vector<bitfield> buffer;
+    bitfield *dic;
+    size_type blocks;
+    static size_type word(const size_type index) {
+      return index / blocksize * blockwords + index % blocksize / wordsize + 2;
+    }
+
+  public:
+    size_type cnt;
+    value_type bit;
+    ::std::vector<weight_type> sum;
+    bitvector()
+        : buffer(), dic(nullptr), blocks(0), cnt(0), bit(0), sum() {}
+    bitvector(const size_type size, const value_type b)
+        : buffer((size / blocksize + 1) * blockwords +
+                     linesize / sizeof(bitfield) - 1,
+                 0),
+          dic(align(buffer)), blocks(size / blocksize + 1), cnt(0), bit(b),
+          sum(size + 1, weight_type(0)) {}
+    bitvector(const bitvector &other)
+        : buffer(other.buffer.size()), dic(align(buffer)),
+          blocks(other.blocks), cnt(other.cnt), bit(other.bit),
+          sum(other.sum) {
+      ::std::copy(other.dic, other.dic + blocks * blockwords, dic);
+    }
+    bitvector(bitvector &&) = default;
+    bitvector &operator=(const bitvector &other) {
+      return *this = bitvector(other);
+    }
+    bitvector &operator=(bitvector &&) = default;
+    void store(const size_type index, const bitfield bits) {
+      dic[word(index)] = bits;
+    }
+    void build() {
+      bitfield total = 0;
+      for (size_type i = 0; i != blocks * blockwords; i += blockwords) {
+        bitfield rel = 0, local = 0;
+        for (size_type j = 0; j != blockwords - 2; ++j) {
+          rel |= local << (j * fieldsize);
+          local += popcount(dic[i + 2 + j]);
+        }
+        dic[i] = total;
+        dic[i + 1] = rel;
+        total += local;
+      }
+    }
+    size_type rank(const size_type last) const {
+      const size_type head = last / blocksize * blockwords,
+                      w = last % blocksize / wordsize;
+      return static_cast<size_type>(dic[head]) +
+             static_cast<size_type>(dic[head + 1] >> (w * fieldsize) &
+                                    ((1 << fieldsize) - 1)) +
+             popcount(dic[head + 2 + w] &
+                      ((static_cast<bitfield>(1) << (last % wordsize)) - 1));
+    }
+    bool access(const size_type index) const {
+      return dic[word(index)] >> (index % wordsize) & 1;
+    }
+    weight_type fold(const size_type first, const size_type last) const {
+      return sum[last] - sum[first];
+    }
+  };
+  static bool valid(const value_type value) {
+    return value == none || !(value >> (Bitlength - 1) >> 1);
+  }
+  ::std::array<bitvector, Bitlength> matrix;
+  size_type size_;
+
+  weight_type at_least(size_type first, size_type last,
+                       const value_type value) const {
+    weight_type ret(0);
+    for (const auto &v : matrix) {
+      const size_type l = v.rank(first), r = v.rank(last);
+      if (value & v.bit) {
+        first = l + v.cnt;
+        last = r + v.cnt;
+      } else {
+        ret = ret + v.fold(l + v.cnt, r + v.cnt);
+        first -= l;
+        last -= r;
+      }
+    }
+    return ret + matrix.back().fold(first, last);
+  }
+  void construct(::std::vector<value_type> values,
+                 ::std::vector<weight_type> weights) {
+    const size_type len = values.size();
+    size_ = len;
+    ::std::vector<value_type> values_next(len);
+    ::std::vector<weight_type> weights_next(len);
+    value_type temp = static_cast<value_type>(1) << (Bitlength - 1);
+    for (auto &v : matrix) {
+      v = bitvector(len, temp);
+      temp >>= 1;
+      size_type ones = 0;
+      for (size_type j = 0; j < len; j += 64) {
+        const size_type e = ::std::min(j + 64, len);
+        ::std::uint_least64_t bits = 0;
+        for (size_type k = j; k != e; ++k) {
+          const bool b = values[k] & v.bit;
+          bits |= static_cast<::std::uint_least64_t>(b) << (k - j);
+          ones += b;
+        }
+        v.store(j, bits);
+      }
+      v.cnt = len - ones;
+      v.build();
+      size_type l = 0, r = v.cnt;
+      for (size_type j = 0; j != len; ++j) {
+        const bool b = values[j] & v.bit;
+        values_next[b ? r : l] = values[j];
+        weights_next[b ? r : l] = weights[j];
+        r += b;
+        l += !b;
+      }
+      ::std::swap(values, values_next);
+      ::std::swap(weights, weights_next);
+      for (size_type j = 0; j != len; ++j)
+        v.sum[j + 1] = v.sum[j] + weights[j];
+    }
+  }
+
+public:
+  weighted_wavelet_matrix() : matrix(), size_(0) {}
+  template <class InputIter>
+  weighted_wavelet_matrix(InputIter first, InputIter last)
+      : matrix(), size_(0) {
+    ::std::vector<value_type> values(first, last);
+    ::std::vector<weight_type> weights(values.begin(), values.end());
+    construct(::std::move(values), ::std::move(weights));
+  }
+  template <class InputIter, class WeightIter>
+  weighted_wavelet_matrix(InputIter first, InputIter last, WeightIter weight)
+      : matrix(), size_(0) {
+    ::std::vector<value_type> values(first, last);
+    ::std::vector<weight_type> weights;
+    weights.reserve(values.size());
+    for (size_type i = 0; i != values.size(); ++i, ++weight)
+      weights.push_back(*weight);
+    construct(::std::move(values), ::std::move(weights));
+  }
+
+  size_type size() const noexcept { return size_; }
+  bool empty() const noexcept { return size() == 0; }
+
+  value_type operator[](size_type index) const {
+    assert(index < size());
+    value_type ret = 0;
+    for (const auto &v : matrix)
+      if (v.access(index))
+        ret |= v.bit, index = v.rank(index) + v.cnt;
+      else
+        index -= v.rank(index);
+    return ret;
+  }
+
+  weight_type rangesum(const size_type first, const size_type last,
+                       const value_type lower, const value_type upper) const {
+    assert(first <= size());
+    assert(last <= size());
+    assert(first <= last);
+    assert(valid(lower));
+    assert(valid(upper));
+    assert(lower == none || upper == none || lower <= upper);
+    const weight_type ret = at_least(first, last, lower == none ? 0 : lower);
+    return upper == none ? ret : ret - at_least(first, last, upper);
+  }
+  weight_type topk_sum(size_type first, size_type last, size_type k) const {
+    assert(first <= size());
+    assert(last <= size());
+    assert(first <= last);
+    k = ::std::min(k, last - first);
+    weight_type ret(0);
+    for (const auto &v : matrix) {
+      const size_type l = v.rank(first), r = v.rank(last);
+      if (r - l >= k) {
+        first = l + v.cnt;
+        last = r + v.cnt;
+      } else {
+        ret = ret + v.fold(l + v.cnt, r + v.cnt);
+        k -= r - l;
+        first -= l;
+        last -= r;
+      }
+    }
+    return ret + matrix.back().fold(first, first + k);
+  }
+};
+
+/*
+
+template<class Integral, ::std::size_t Bitlength, Integral None, class Weight>
+class weighted_wavelet_matrix;
+
+weighted_wavelet_matrix は静的な非負整数列の各要素に重みを持たせ、
+区間の値の範囲に含まれる要素の重みの和を処理するデータ構造です
+wavelet_matrix の各段の bit 列に加えて、
+その段で並べ替えた後の順に重みの累積和を保持します
+空間計算量 O(N*Bitlength)
+
+
+テンプレートパラメータ
+-class Integral
+ 要素となる整数型
+
+-::std::size_t Bitlength
+ 扱うbit幅 ([0, 2^Bitlength) の範囲を扱います)
+
+-Integral None
+ 関数の引数において、値が存在しないことを表現することに使用します
+
+-class Weight
+ 重みの型
+ weight_type(0) が加法の単位元となり、+ と - で加減算できる必要があります
+
+
+メンバ型
+-value_type
+ 要素の型 (Integral)
+
+-weight_type
+ 重みの型 (Weight)
+
+-size_type
+ 符号なし整数型 (::std::size_t)
+
+
+メンバ定数
+-none
+ None
+
+
+-メンバ関数
+template <class InputIter>
+-(constructor) (InputIter first, InputIter last)
+ [first, last) の要素から weighted_wavelet_matrix を構築します
+ 各要素の重みは要素の値を weight_type に変換したものとなります
+ 時間計算量 O(N*Bitlength)
+
+template <class InputIter, class WeightIter>
+-(constructor) (InputIter first, InputIter last, WeightIter weight)
+ [first, last) の要素から weighted_wavelet_matrix を構築します
+ i 番目の要素の重みは weight から i 個進めた位置の値となります
+ 時間計算量 O(N*Bitlength)
+
+-size ()->size_type
+ 要素数を返します
+ 時間計算量 O(1)
+
+-empty ()->bool
+ size()==0 と同値です
+ 時間計算量 O(1)
+
+-operator[] (size_type index)->value_type
+ index で指定した要素の値を返します
+ 時間計算量 O(Bitlength)
+
+-rangesum (size_type first, size_type last,
+           value_type lower, value_type upper)->weight_type
+ [first, last) で lower 以上 upper 未満の要素の重みの和を返します
+ lower = none のとき下限は存在しません
+ upper = none のとき上限は存在しません
+ 下限、上限が両方存在するとき、lower <= upper が要求されます
+ 時間計算量 O(Bitlength)
+
+-topk_sum (size_type first, size_type last, size_type k)->weight_type
+ [first, last) で値の大きい方から k 個の要素の重みの和を返します
+ 値が等しい要素は位置が前のものを優先します
+ k が last - first より大きい場合、全ての要素の重みの和を返します
+ 時間計算量 O(Bitlength)
+
+※N:全体の要素数
+※各段の bit 列は wavelet_matrix と同じく 64 バイト境界に揃えた形式で保持し、
+  rank は 1 つのキャッシュラインのみを参照します
+※popcount() の時間計算量を O(1) と仮定
+
+*/